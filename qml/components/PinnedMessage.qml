@@ -31,26 +31,34 @@ Row {
 
             MouseArea {
                 anchors.fill: parent
-                onClicked: messages.positionViewAtIndex(chatProxyModel.mapFromSource(chat.getMessageIndex(chat.pinnedMessageId)), ListView.SnapPosition)
+                onClicked: chat.jumpToMessage(chat.pinnedMessageId)
             }
         }
         Label {
             id: pinnedText
             width: pinnedMessage - Theme.paddingLarge
             text: chat.pinnedMessageId === 0 ? "" :
-                      (pinnedMessage.getPinnedData("messageType") === "text" ? pinnedMessage.getPinnedData("messageText").trim().replace(/\r?\n|\r/g, " ")
+                      (pinnedMessage.getPinnedData("messageType") === "text" ? pinnedMessage.getPinnedData("messageText")
                                                                            : pinnedMessage.getPinnedData("messageType"))
             truncationMode: TruncationMode.Fade
 
             MouseArea {
                 anchors.fill: parent
-                onClicked: messages.positionViewAtIndex(chatProxyModel.mapFromSource(chat.getMessageIndex(chat.pinnedMessageId)), ListView.SnapPosition)
+                onClicked: chat.jumpToMessage(chat.pinnedMessageId)
             }
         }
     }
 
+    property int summaryRevision: 0
+
+    Connections {
+        target: chat
+        onReplySummaryChanged: if (messageId === chat.pinnedMessageId) summaryRevision++
+    }
+
     function getPinnedData(roleName) {
-        var result = chatProxyModel.data(chatProxyModel.index(chatProxyModel.mapFromSource(chat.getMessageIndex(chat.pinnedMessageId)), 0), chatProxyModel.roleForName(roleName))
+        summaryRevision
+        var result = chat.getReplySummary(chat.pinnedMessageId)[roleName]
         if (result === void(0)) return "";
         return result
     }
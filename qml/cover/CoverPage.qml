@@ -7,4 +7,25 @@ CoverBackground {
         anchors.centerIn: parent
         text: qsTr("Yottagram (dev)")
     }
+
+    Column {
+        anchors.top: label.bottom
+        anchors.topMargin: Theme.paddingLarge
+        anchors.horizontalCenter: parent.horizontalCenter
+        visible: chatList.unreadMessageCount > 0
+
+        Label {
+            anchors.horizontalCenter: parent.horizontalCenter
+            text: chatList.unreadMessageCount
+            font.pixelSize: Theme.fontSizeHuge
+            color: Theme.highlightColor
+        }
+
+        Label {
+            anchors.horizontalCenter: parent.horizontalCenter
+            text: qsTr("%n unread chat(s)", "", chatList.unreadChatCount)
+            font.pixelSize: Theme.fontSizeExtraSmall
+            color: Theme.secondaryColor
+        }
+    }
 }
@@ -4,9 +4,9 @@ import QtGraphicalEffects 1.0
 import org.nemomobile.notifications 1.0
 import org.nemomobile.configuration 1.0
 import Sailfish.Pickers 1.0
-import SortFilterProxyModel 0.2
 import com.verdanditeam.user 1.0
 import com.verdanditeam.audiorecorder 1.0
+import com.verdanditeam.textbubble 1.0
 //import "qrc:///vendor/vendor/lottie/src/qml/"
 import "../components/functions/muteFormat.js" as TimeFormat
 import "../components"
@@ -20,6 +20,7 @@ Page {
     property string pluginName: ""
     property int type: 0
     property var chat: null
+    property var chatId: 0
     property var replyMessageId: 0
     property var editMessageId: 0
     property variant selection: []
@@ -29,12 +30,18 @@ Page {
 
     allowedOrientations: Orientation.All
 
+    Component.onCompleted: {
+        chatId = chat.id
+        chatList.pinChat(chatId)
+    }
+    Component.onDestruction: chatList.unpinChat(chatId)
+
     onStatusChanged: {
 //        bubble.canvas.requestPaint()
-        if (status === PageStatus.Deactivating) chatList.closeChat(chat.id)
+        if (status === PageStatus.Deactivating) chatList.closeChat(chatId)
         if (status === PageStatus.Active) {
-            chatList.openChat(chat.id)
-            chat.getChatHistory(0)
+            chat = chatList.openChat(chatId)
+            chat.loadHistory(Math.ceil(chatPage.height / Theme.itemSizeSmall))
 
             switch (chat.getChatType()) {
             case "private":
@@ -55,7 +62,7 @@ Page {
 
     Connections {
         target: Qt.application
-        onStateChanged: if (Qt.application.state === Qt.ApplicationInactive) chatList.closeChat(chat.id); else if (Qt.application.state === Qt.ApplicationActive) chatList.openChat(chat.id)
+        onStateChanged: if (Qt.application.state === Qt.ApplicationInactive) chatList.closeChat(chatId); else if (Qt.application.state === Qt.ApplicationActive) chat = chatList.openChat(chatId)
     }
 
     function addZero(i) {
@@ -65,14 +72,6 @@ Page {
         return i;
     }
 
-    SortFilterProxyModel {
-        id: chatProxyModel
-        sourceModel: chat
-        sorters: [
-            RoleSorter { roleName: "messageId"; sortOrder: Qt.DescendingOrder}
-        ]
-    }
-
     Loader {
         id: pageLoader
         anchors.fill: parent
@@ -117,6 +116,12 @@ Page {
                     onClicked: pageStack.push(ttlDialog)
                 }
 
+                MenuItem {
+                    text: qsTr("Go to first unread")
+                    visible: chat.unreadCount > 0 && !chatPage.selectionActive
+                    onClicked: chat.jumpToFirstUnread()
+                }
+
                 MenuItem {
                     text: qsTr("Cancel selection")
                     visible: chatPage.selectionActive
@@ -273,18 +278,191 @@ Page {
                     width: parent.width
                     verticalLayoutDirection: ListView.BottomToTop
                     clip: true
-                    model: chatProxyModel
+                    model: chat
                     cacheBuffer: 0
 
-                    onCountChanged: if(count < 10) chat.getChatHistory(0)
+                    onCountChanged: if(count < 10) chat.getMoreChatHistory()
 
                     onAtYBeginningChanged: if (atYBeginning) chat.getMoreChatHistory()
                     onAtYEndChanged: contentY--
-                    Component.onCompleted: contentY--
+                    Component.onCompleted: {
+                        contentY--
+                        updateTextLayout()
+                    }
+
+                    function updateTextLayout() {
+                        chat.setTextLayout(textLayoutLabel.font, textLayoutLabel.width)
+                    }
+
+                    LinkedLabel {
+                        id: textLayoutLabel
+                        width: chatPage.width/chatPage.messageWidth
+                        font.pixelSize: Theme.fontSizeMedium
+                        wrapMode: Text.WrapAtWordBoundaryOrAnywhere
+                        visible: false
+                        onWidthChanged: messages.updateTextLayout()
+                        onFontChanged: messages.updateTextLayout()
+                    }
+
+                    onContentYChanged: {
+                        if ((contentY - originY) < 5000) chat.getMoreChatHistory()
+                        if ((originY + contentHeight - height - contentY) < 5000) chat.getNewerChatHistory()
+                        if (!missingMessagesTimer.running) missingMessagesTimer.start()
+                    }
+
+                    Timer {
+                        id: missingMessagesTimer
+                        interval: 200
+                        repeat: false
+                        onTriggered: chat.loadMissingMessages(Math.max(messages.indexAt(0, messages.contentY + messages.height), 0), messages.indexAt(0, messages.contentY) === -1 ? messages.count : messages.indexAt(0, messages.contentY))
+                    }
 
-                    onContentYChanged: if ((contentY - originY) < 5000) chat.getMoreChatHistory()
+                    Connections {
+                        target: chat
+                        onMessageJumpReady: messages.positionViewAtIndex(chat.getMessageIndex(messageId), ListView.SnapPosition)
+                    }
 
-                    delegate:
+                    delegate: Loader {
+                        width: parent.width
+                        sourceComponent: messageType == "text" && replyMessageId === 0 && !hasWebPage ? plainTextComponent : messageComponent
+
+                        Component {
+                            id: plainTextComponent
+
+                            ListItem {
+                                id: plainItem
+                                width: parent.width
+                                contentHeight: Math.max(textBubble.height + 2 * Theme.paddingSmall, Theme.itemSizeMedium)
+                                contentWidth: width
+                                property bool displayAvatar: received && (type === "group" || type === "supergroup")
+                                readonly property var user: users.getUserAsVariant(authorId)
+                                highlighted: selection.indexOf(messageId) !== -1
+
+                                function toggleSelection() {
+                                    if (selection.indexOf(messageId) === -1) {
+                                        selection.push(messageId)
+                                        if (chatPage.selectionActive === false) chatPage.selectionActive = true
+                                    } else {
+                                        selection.splice(selection.indexOf(messageId), 1)
+                                        if (chatPage.selectionActive === true && chatPage.selection.length == 0) chatPage.selectionActive = false
+                                    }
+                                    highlighted = selection.indexOf(messageId) !== -1
+                                }
+
+                                onClicked: {
+                                    if (chatPage.selectionActive) {
+                                        toggleSelection()
+                                        return
+                                    }
+
+                                    var position = mapToItem(textBubble, mouse.x, mouse.y)
+                                    var link = textBubble.linkAt(position.x, position.y)
+                                    if (link !== "") Qt.openUrlExternally(link)
+                                }
+
+                                function remove() {
+                                    remorseAction("Deleting", function() { chat.deleteMessage(messageId) })
+                                }
+
+                                function getForwardName() {
+                                    if (forwardUserId !== 0) return users.getUserAsVariant(forwardUserId).name;
+                                    if (forwardUsername !== "") return forwardUsername;
+                                    if (forwardChannelId !== 0) return chatList.getChatTitle(forwardChannelId)
+                                }
+
+                                Connections {
+                                    target: chatPage
+                                    onSelectionActiveChanged: {
+                                        if (chatPage.selectionActive === false) {
+                                            highlighted = false
+                                        }
+                                    }
+                                }
+
+                                Component.onCompleted: {
+                                    if (!isRead && received) chat.setMessageAsRead(messageId)
+                                }
+
+                                menu: Component {
+                                    ContextMenu {
+                                        MenuItem {
+                                            text: qsTr("Reply")
+                                            visible: chatList.selection.length === 0
+                                            onClicked: {
+                                                chatPage.editMessageId = 0
+                                                chatPage.replyMessageId = messageId
+                                            }
+                                        }
+
+                                        MenuItem {
+                                            text: qsTr("Edit")
+                                            visible: canBeEdited && chatList.selection.length === 0
+                                            onClicked: {
+                                                textInput.text = messageText
+                                                chatPage.editMessageId = messageId
+                                                chatPage.replyMessageId = 0
+                                            }
+                                        }
+
+                                        MenuItem {
+                                            text: qsTr("Copy")
+                                            onClicked: Clipboard.text = messageText.trim()
+                                        }
+
+                                        MenuItem {
+                                            text: qsTr("Delete")
+                                            visible: canBeDeleted
+                                            onClicked: plainItem.remove()
+                                        }
+
+                                        MenuItem {
+                                            text: plainItem.highlighted ? qsTr("Deselect") : qsTr("Select")
+                                            visible: chatList.selection.length === 0
+                                            onClicked: plainItem.toggleSelection()
+                                        }
+                                    }
+                                }
+
+                                Avatar {
+                                    width: Theme.itemSizeExtraSmall
+                                    height: width
+                                    anchors.left: parent.left
+                                    anchors.leftMargin: Theme.horizontalPageMargin
+                                    anchors.bottom: parent.bottom
+                                    anchors.bottomMargin: Theme.paddingMedium
+                                    visible: displayAvatar && chat.getAuthorByIndex(index-1) !== authorId
+                                    userName: user.name
+                                    avatarPhoto: if (user && user.hasPhoto) user.smallPhoto
+                                }
+
+                                TextBubble {
+                                    id: textBubble
+                                    y: Theme.paddingSmall
+                                    anchors.left: if (received) parent.left
+                                    anchors.leftMargin: Theme.horizontalPageMargin + (displayAvatar ? (Theme.itemSizeExtraSmall + Theme.paddingMedium) : 0)
+                                    anchors.right: if (!received) parent.right
+                                    anchors.rightMargin: if (!received) Theme.horizontalPageMargin
+                                    text: messageText
+                                    author: (displayAvatar && chat.getAuthorByIndex(index+1) !== authorId) || isForwarded || chat.getChatType() === "channel"
+                                            ? (!isForwarded ? (chat.getChatType() === "channel" ? chat.title : user.name) : qsTr("Forwarded from %1").arg(getForwardName())) : ""
+                                    time: (edited ? qsTr("Edited") + " ": "") + timestamp
+                                    isRead: model.isRead
+                                    received: model.received
+                                    font.pixelSize: Theme.fontSizeMedium
+                                    timeFont.pixelSize: Theme.fontSizeExtraSmall
+                                    color: Theme.primaryColor
+                                    authorColor: Theme.highlightColor
+                                    linkColor: Theme.highlightColor
+                                    timeColor: Theme.secondaryColor
+                                    backgroundColor: Theme.rgba(Theme.highlightBackgroundColor, Theme.highlightBackgroundOpacity)
+                                    maximumWidth: chatPage.width/chatPage.messageWidth
+                                    padding: Theme.paddingSmall
+                                    radius: Theme.paddingMedium
+                                }
+                            }
+                        }
+
+                        property Component messageComponent:
                     ListItem {
                         id: item
                         width: parent.width
@@ -391,7 +569,7 @@ Page {
                             anchors.leftMargin: Theme.horizontalPageMargin
                             anchors.bottom: parent.bottom
                             anchors.bottomMargin: Theme.paddingMedium
-                            visible: displayAvatar && chat.getAuthorByIndex(chatProxyModel.mapToSource(index-1)) !== authorId
+                            visible: displayAvatar && chat.getAuthorByIndex(index-1) !== authorId
                             userName: user.name
                             avatarPhoto: if (user && user.hasPhoto) user.smallPhoto
                         }
@@ -411,12 +589,12 @@ Page {
                                 font.pixelSize: Theme.fontSizeMedium
                                 horizontalAlignment: received ? Text.AlignLeft : Text.AlignRight
                                 color: Theme.highlightColor
-                                visible: ((displayAvatar && chat.getAuthorByIndex(chatProxyModel.mapToSource(index+1)) !== authorId) ||  isForwarded || chat.getChatType() === "channel") && !serviceMessage.visible
+                                visible: ((displayAvatar && chat.getAuthorByIndex(index+1) !== authorId) ||  isForwarded || chat.getChatType() === "channel") && !serviceMessage.visible
 
                                 function getName() {
                                     if (forwardUserId !== 0) return users.getUserAsVariant(forwardUserId).name;
                                     if (forwardUsername !== "") return forwardUsername;
-                                    if (forwardChannelId !== 0) return chatList.getChatAsVariant(forwardChannelId).title
+                                    if (forwardChannelId !== 0) return chatList.getChatTitle(forwardChannelId)
                                 }
                             }
 
@@ -453,19 +631,19 @@ Page {
 
                                             MouseArea {
                                                 anchors.fill: parent
-                                                onClicked: messages.positionViewAtIndex(chatProxyModel.mapFromSource(chat.getMessageIndex(replyMessageId)), ListView.SnapPosition)
+                                                onClicked: chat.jumpToMessage(replyMessageId)
                                             }
                                         }
                                         Label {
                                             id: replyText
                                             text: replyMessageId === 0 ? "" :
-                                                      (replyMessage.getReplyData("messageType") === "text" ? replyMessage.getReplyData("messageText").trim().replace(/\r?\n|\r/g, " ")
+                                                      (replyMessage.getReplyData("messageType") === "text" ? replyMessage.getReplyData("messageText")
                                                                                                            : replyMessage.getReplyData("messageType"))
                                             truncationMode: TruncationMode.Fade
 
                                             MouseArea {
                                                 anchors.fill: parent
-                                                onClicked: messages.positionViewAtIndex(chatProxyModel.mapFromSource(chat.getMessageIndex(replyMessageId)), ListView.SnapPosition)
+                                                onClicked: chat.jumpToMessage(replyMessageId)
                                             }
                                         }
                                     }
@@ -486,7 +664,7 @@ Page {
                                     ]
 
                                     function getReplyData(roleName) {
-                                        var result = chatProxyModel.data(chatProxyModel.index(chatProxyModel.mapFromSource(chat.getMessageIndex(replyMessageId)), 0), chatProxyModel.roleForName(roleName))
+                                        var result = replySummary[roleName]
                                         if (result === void(0)) return "";
                                         return result
                                     }
@@ -739,7 +917,7 @@ Page {
                                     PropertyChanges {
                                         target: textField
                                         width: chatPage.width/chatPage.messageWidth
-                                        height: textField.paintedHeight
+                                        height: textHeight > 0 && chat.textLayoutWidth === textField.width ? textHeight : textField.paintedHeight
                                     }
                                 },
                                 State {
@@ -754,6 +932,7 @@ Page {
                             ]
                         }
                     }
+                    }
 
                     VerticalScrollDecorator {}
                 }
@@ -809,8 +988,16 @@ Page {
                         spacing: Theme.paddingLarge
                         visible: chatPage.replyMessageId !== 0
 
+                        property int summaryRevision: 0
+
                         function getReplyData(roleName) {
-                            return chatProxyModel.data(chatProxyModel.index(chatProxyModel.mapFromSource(chat.getMessageIndex(chatPage.replyMessageId)), 0), chatProxyModel.roleForName(roleName))
+                            summaryRevision
+                            return chat.getReplySummary(chatPage.replyMessageId)[roleName]
+                        }
+
+                        Connections {
+                            target: chat
+                            onReplySummaryChanged: if (messageId === chatPage.replyMessageId) replyRow.summaryRevision++
                         }
 
                         Icon {
@@ -857,7 +1044,7 @@ Page {
                         visible: chatPage.editMessageId !== 0
 
                         function getEditData(roleName) {
-                            return chatProxyModel.data(chatProxyModel.index(chatProxyModel.mapFromSource(chat.getMessageIndex(chatPage.editMessageId)), 0), chatProxyModel.roleForName(roleName))
+                            return chat.getMessageData(chatPage.editMessageId, roleName)
                         }
 
                         Icon {
@@ -1,6 +1,5 @@
 import QtQuick 2.0
 import Sailfish.Silica 1.0
-import SortFilterProxyModel 0.2
 import org.nemomobile.dbus 2.0
 import QtGraphicalEffects 1.0
 import "../components"
@@ -10,6 +9,10 @@ Page {
 
     allowedOrientations: Orientation.All
     property int currentChatList: 0
+    onCurrentChatListChanged: searchModel.chatList = currentChatList
+    readonly property var searchModel: chatList.getSearchModel()
+    readonly property var mainChatListModel: chatList.getChatListModel(0)
+    readonly property var archiveChatListModel: chatList.getChatListModel(1)
 
     DBusAdaptor {
         id: shareDBusInterface
@@ -64,9 +67,14 @@ Page {
             }
 
             MenuItem {
-                text: page.currentChatList == 0 ? qsTr("Archived chats") : qsTr("Main chats")
+                visible: authorization.isAuthorized
+                text: qsTr("Mark all as read")
+                onClicked: chatList.markChatListAsRead(page.currentChatList)
+            }
+
+            MenuItem {
+                text: page.currentChatList == 0 ? (chatList.archiveUnreadChatCount > 0 ? qsTr("Archived chats (%L1)").arg(chatList.archiveUnreadChatCount) : qsTr("Archived chats")) : qsTr("Main chats")
                 onClicked: page.currentChatList == 0 ? page.currentChatList = 1 : page.currentChatList = 0
-                visible: false
             }
         }
 
@@ -75,6 +83,7 @@ Page {
             width: parent.width
             anchors.top: parent.top
             placeholderText: qsTr("Search")
+            onTextChanged: page.searchModel.query = text
             Keys.onReturnPressed: {
                 if(searchField.text.length != 0) {
                     app.playlistModel.search(searchField.text)
@@ -84,31 +93,6 @@ Page {
 
         contentHeight: parent.height
 
-        SortFilterProxyModel {
-            id: chatListProxyModel
-            sourceModel: chatList
-            sorters: [
-                RoleSorter { roleName: "order"; sortOrder: Qt.DescendingOrder }
-            ]
-            filters: [
-                ValueFilter {
-                    roleName: "order"
-                    value: false
-                    inverted: true
-                },
-                ValueFilter {
-                    roleName: "chatlist"
-                    value: page.currentChatList
-                },
-                RegExpFilter {
-                    roleName: "name"
-                    pattern: "^" + searchField.text
-                    caseSensitivity: Qt.CaseInsensitive
-                    enabled: searchField.text !== ""
-                }
-            ]
-        }
-
         SilicaListView {
             id: listView
             anchors.top: searchField.bottom
@@ -117,7 +101,7 @@ Page {
             anchors.bottom: parent.bottom
             clip: true
             spacing: 0
-            model: chatListProxyModel
+            model: searchField.text !== "" ? page.searchModel : (page.currentChatList == 0 ? page.mainChatListModel : page.archiveChatListModel)
             cacheBuffer: 0
             delegate: ListItem {
                 id: listItem
@@ -142,9 +126,11 @@ Page {
                                 var list = chatList
                                 var chatId = id
                                 remorseAction("Deleting", function() {
+                                    list.pinChat(chatId)
                                     var chat = list.getChatAsVariant(chatId)
                                     chat.clearHistory(true)
                                     if (chat.getChatType() === "secret") chat.closeSecretChat()
+                                    list.unpinChat(chatId)
                                 })
                             }
                         }
@@ -240,6 +226,7 @@ Page {
                     anchors.rightMargin: Theme.paddingLarge
                 }
 
+                onPressed: chatList.prefetchChat(id)
                 onClicked: {
                     var chat = chatList.openChat(id)
                     pageStack.push(Qt.resolvedUrl("Chat.qml"), { chat: chat })
@@ -24,63 +24,73 @@ along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
 #include <QFileInfo>
 #include <QDesktopServices>
 #include <QQmlEngine>
+#include <QSettings>
+#include <algorithm>
+#include <functional>
 #include "overloaded.h"
 
-Chat::Chat(td_api::chat* chat, shared_ptr<Files> files) : _chat(chat), _files(files), _secretChat(nullptr), _notificationSettings(nullptr), _scopeNotificationSettings(nullptr)
-{
+const int Chat::MAX_LOADED_MESSAGES = 300;
+const int Chat::HISTORY_PAGE_SIZE = 20;
+const int Chat::MAX_HISTORY_PAGE_SIZE = 100;
+const int Chat::VIEW_MESSAGES_INTERVAL = 100;
+const int Chat::WARM_PAGE_SIZE = 30;
+const int Chat::MAX_POOLED_MESSAGES = 100;
+const int Chat::MAX_POOLED_CONTENTS = 50;
+const int Chat::REPLY_CACHE_SIZE = 200;
+const int Chat::REPLY_TEXT_LENGTH = 100;
+const qint64 Chat::LOCAL_MESSAGE_ID_BASE = Q_INT64_C(1) << 62;
+const int Chat::FORWARD_BATCH_SIZE = 100;
+
+Chat::Chat(ChatSummary* summary, shared_ptr<Files> files) : _summary(summary), _contentPool(MAX_POOLED_CONTENTS), _files(files), _scopeNotificationSettings(nullptr)
+{
+    _historyPageSize = HISTORY_PAGE_SIZE;
+    _maxPooledMessages = MAX_POOLED_MESSAGES;
+    _lastLocalMessageId = LOCAL_MESSAGE_ID_BASE;
+    _chatType = _summary->getChatType();
+    _replySummaries.setMaxCost(REPLY_CACHE_SIZE);
+
+    _viewedMessagesTimer.setInterval(VIEW_MESSAGES_INTERVAL);
+    _viewedMessagesTimer.setSingleShot(true);
+    connect(&_viewedMessagesTimer, SIGNAL(timeout()), this, SLOT(flushViewedMessages()));
     _basicGroupFullInfo = new BasicGroupFullInfo();
     _supergroupFullInfo = new SupergroupFullInfo();
-    _notificationSettings = move(chat->notification_settings_);
-    setLastReadInboxMessageId(chat->last_read_inbox_message_id_);
-    setLastReadOutboxMessageId(chat->last_read_outbox_message_id_);
-    setUnreadCount(_chat->unread_count_);
-
-    if (this->hasPhoto()) {
-        setChatPhoto(std::move(chat->photo_));
-    }
+    _lastReadInboxMessageId = _summary->lastReadInboxMessageId;
+    _lastReadOutboxMessageId = _summary->lastReadOutboxMessageId;
 }
 
 Chat::~Chat()
 {
-    delete _secretChat;
-    delete _chat;
+    flushViewedMessages();
+    qDeleteAll(_messages);
+    qDeleteAll(_messagePool);
+    delete _basicGroupFullInfo;
+    delete _supergroupFullInfo;
 }
 
 qint64 Chat::getId() const
 {
-    return _chat->id_;
+    return _summary->getId();
 }
 
 qint32 Chat::getIdFromType() const
 {
-    switch (_chat->type_->get_id()) {
-    case td_api::chatTypeBasicGroup::ID:
-        return static_cast<td_api::chatTypeBasicGroup*>(_chat->type_.get())->basic_group_id_;
-    case td_api::chatTypePrivate::ID:
-        return static_cast<td_api::chatTypePrivate*>(_chat->type_.get())->user_id_;
-    case td_api::chatTypeSecret::ID:
-        return static_cast<td_api::chatTypeSecret*>(_chat->type_.get())->user_id_;
-    case td_api::chatTypeSupergroup::ID:
-        return static_cast<td_api::chatTypeSupergroup*>(_chat->type_.get())->supergroup_id_;
-    default:
-        return -1;
-    }
+    return _summary->getIdFromType();
 }
 
 qint32 Chat::getSecretChatId() const
 {
-    return static_cast<td_api::chatTypeSecret*>(_chat->type_.get())->secret_chat_id_;
+    return _summary->getSecretChatId();
 }
 
 QString Chat::getTitle() const
 {
-    return QString::fromStdString(_chat->title_);
+    return _summary->getTitle();
 }
 
 UserFullInfo* Chat::getUserFullInfo() const
 {
-    if (_chat->type_->get_id() == td_api::chatTypePrivate::ID) {
-        auto fullInfo = _users->getUser(static_cast<td_api::chatTypePrivate*>(_chat->type_.get())->user_id_)->getUserFullInfo();
+    if (_summary->typeId == td_api::chatTypePrivate::ID) {
+        auto fullInfo = _users->getUser(_summary->getIdFromType())->getUserFullInfo();
         QQmlEngine::setObjectOwnership(fullInfo, QQmlEngine::CppOwnership);
         return fullInfo;
     }
@@ -100,56 +110,27 @@ SupergroupFullInfo *Chat::getSupergroupFullInfo() const
 
 qint64 Chat::getOrder() const
 {
-    return _chat->order_;
+    return _summary->order;
 }
 
 void Chat::setOrder(int64_t order)
 {
-    _chat->order_ = order;
+    _summary->order = order;
 }
 
 QString Chat::getChatType() const
 {
-    switch (_chat->type_->get_id()) {
-    case td_api::chatTypeBasicGroup::ID:
-        return "group";
-    case td_api::chatTypePrivate::ID:
-        return "private";
-    case td_api::chatTypeSecret::ID:
-        return "secret";
-    case td_api::chatTypeSupergroup::ID:
-        if (static_cast<td_api::chatTypeSupergroup*>(_chat->type_.get())->is_channel_) return "channel";
-        return "supergroup";
-    default:
-        return "";
-    }
+    return _summary->getChatType();
 }
 
 int Chat::getChatList() const
 {
-    qint32 id;
-    if (_chat->chat_list_ == nullptr) id = td_api::chatListMain::ID;
-    else id = _chat->chat_list_->get_id();
-
-    switch (id) {
-    case td_api::chatListArchive::ID:
-        return ChatList::Archive;
-    case td_api::chatListMain::ID:
-    default:
-        return ChatList::Main;
-    }
+    return _summary->getChatList();
 }
 
 qint32 Chat::getUnreadCount() const
 {
-    return _unreadCount;
-}
-
-void Chat::setUnreadCount(qint32 unreadCount)
-{
-    _unreadCount = unreadCount;
-
-    emit unreadCountChanged(this->getId(), unreadCount);
+    return _summary->unreadCount;
 }
 
 void Chat::setLastReadInboxMessageId(qint64 messageId)
@@ -165,91 +146,52 @@ void Chat::setLastReadOutboxMessageId(qint64 messageId)
     emit lastReadOutboxMessageIdChanged(messageId);
 }
 
-void Chat::setChatPhoto(td_api::object_ptr<td_api::chatPhoto> chatPhoto)
-{
-    if (chatPhoto == nullptr) {
-        _smallPhotoId = 0;
-        _bigPhotoId = 0;
-    } else {
-        _smallPhotoId = chatPhoto->small_->id_;
-        _files->appendFile(std::move(chatPhoto->small_), "avatar");
-        _bigPhotoId = chatPhoto->big_->id_;
-        _files->appendFile(std::move(chatPhoto->big_), "");
-    }
-    _chat->photo_ = std::move(chatPhoto);
-    emit chatPhotoChanged(getId());
-}
-
 bool Chat::isSelf() const
 {
-    if (_chat->type_->get_id() != td_api::chatTypePrivate::ID) return false;
-
-    qint32 userId = getIdFromType();
-    return userId == _manager->getMyId();
-}
-
-void Chat::setIsOpen(bool isOpen)
-{
-    _isOpen = isOpen;
+    return _summary->isSelf(_manager->getMyId());
 }
 
 bool Chat::isOpen() const
 {
-    return _isOpen;
-}
-
-void Chat::setSecretChat(td_api::secretChat *secretChat)
-{
-    _secretChat = secretChat;
+    return _summary->isOpen;
 }
 
 QString Chat::getSecretChatState() const
 {
-    if (_secretChat == nullptr) return "";
-
-    switch (_secretChat->state_->get_id()) {
-    case td_api::secretChatStateReady::ID:
-        return "ready";
-    case td_api::secretChatStateClosed::ID:
-        return "closed";
-    case td_api::secretChatStatePending::ID:
-        return "pending";
-    default:
-        return "";
-    }
+    return _summary->getSecretChatState();
 }
 
 qint32 Chat::getTtl() const
 {
-    if (_secretChat == nullptr) return 0;
+    if (_summary->secretChat == nullptr) return 0;
 
-    return _secretChat->ttl_;
+    return _summary->secretChat->ttl_;
 }
 
 qint32 Chat::getMuteFor() const
 {
-    if (_notificationSettings == nullptr) return 0;
+    if (_summary->notificationSettings == nullptr) return 0;
 
-    if (_notificationSettings->use_default_mute_for_) return _scopeNotificationSettings->mute_for_;
+    if (_summary->notificationSettings->use_default_mute_for_) return _scopeNotificationSettings->mute_for_;
 
-    return _notificationSettings->mute_for_;
+    return _summary->notificationSettings->mute_for_;
 }
 
 void Chat::setMuteFor(qint32 muteFor)
 {
-    if (_notificationSettings == nullptr) return;
+    if (_summary->notificationSettings == nullptr) return;
 
     auto settings = td_api::make_object<td_api::chatNotificationSettings>(
-                _notificationSettings->use_default_mute_for_,
-                _notificationSettings->mute_for_,
-                _notificationSettings->use_default_sound_,
-                _notificationSettings->sound_,
-                _notificationSettings->use_default_show_preview_,
-                _notificationSettings->show_preview_,
-                _notificationSettings->use_default_disable_pinned_message_notifications_,
-                _notificationSettings->disable_pinned_message_notifications_,
-                _notificationSettings->use_default_disable_mention_notifications_,
-                _notificationSettings->disable_mention_notifications_
+                _summary->notificationSettings->use_default_mute_for_,
+                _summary->notificationSettings->mute_for_,
+                _summary->notificationSettings->use_default_sound_,
+                _summary->notificationSettings->sound_,
+                _summary->notificationSettings->use_default_show_preview_,
+                _summary->notificationSettings->show_preview_,
+                _summary->notificationSettings->use_default_disable_pinned_message_notifications_,
+                _summary->notificationSettings->disable_pinned_message_notifications_,
+                _summary->notificationSettings->use_default_disable_mention_notifications_,
+                _summary->notificationSettings->disable_mention_notifications_
     );
     settings->use_default_mute_for_ = _scopeNotificationSettings->mute_for_ == muteFor;
     settings->mute_for_ = muteFor;
@@ -258,35 +200,35 @@ void Chat::setMuteFor(qint32 muteFor)
 
 bool Chat::getDefaultMuteFor() const
 {
-    if (_notificationSettings == nullptr) return false;
+    if (_summary->notificationSettings == nullptr) return false;
 
-    return _scopeNotificationSettings->mute_for_ == _notificationSettings->mute_for_;
+    return _scopeNotificationSettings->mute_for_ == _summary->notificationSettings->mute_for_;
 }
 
 bool Chat::getShowPreview() const
 {
-    if (_notificationSettings == nullptr) return 0;
+    if (_summary->notificationSettings == nullptr) return 0;
 
-    if (_notificationSettings->use_default_show_preview_) return _scopeNotificationSettings->show_preview_;
+    if (_summary->notificationSettings->use_default_show_preview_) return _scopeNotificationSettings->show_preview_;
 
-    return _notificationSettings->show_preview_;
+    return _summary->notificationSettings->show_preview_;
 }
 
 void Chat::setShowPreview(bool showPreview)
 {
-    if (_notificationSettings == nullptr) return;
+    if (_summary->notificationSettings == nullptr) return;
 
     auto settings = td_api::make_object<td_api::chatNotificationSettings>(
-                _notificationSettings->use_default_mute_for_,
-                _notificationSettings->mute_for_,
-                _notificationSettings->use_default_sound_,
-                _notificationSettings->sound_,
-                _notificationSettings->use_default_show_preview_,
-                _notificationSettings->show_preview_,
-                _notificationSettings->use_default_disable_pinned_message_notifications_,
-                _notificationSettings->disable_pinned_message_notifications_,
-                _notificationSettings->use_default_disable_mention_notifications_,
-                _notificationSettings->disable_mention_notifications_
+                _summary->notificationSettings->use_default_mute_for_,
+                _summary->notificationSettings->mute_for_,
+                _summary->notificationSettings->use_default_sound_,
+                _summary->notificationSettings->sound_,
+                _summary->notificationSettings->use_default_show_preview_,
+                _summary->notificationSettings->show_preview_,
+                _summary->notificationSettings->use_default_disable_pinned_message_notifications_,
+                _summary->notificationSettings->disable_pinned_message_notifications_,
+                _summary->notificationSettings->use_default_disable_mention_notifications_,
+                _summary->notificationSettings->disable_mention_notifications_
     );
     settings->use_default_show_preview_ = _scopeNotificationSettings->show_preview_ == showPreview;
     settings->show_preview_ = showPreview;
@@ -295,35 +237,35 @@ void Chat::setShowPreview(bool showPreview)
 
 bool Chat::getDefaultShowPreview() const
 {
-    if (_notificationSettings == nullptr) return false;
+    if (_summary->notificationSettings == nullptr) return false;
 
-    return _scopeNotificationSettings->show_preview_ == _notificationSettings->show_preview_;
+    return _scopeNotificationSettings->show_preview_ == _summary->notificationSettings->show_preview_;
 }
 
 bool Chat::getDisablePinnedMessageNotifications() const
 {
-    if (_notificationSettings == nullptr) return 0;
+    if (_summary->notificationSettings == nullptr) return 0;
 
-    if (_notificationSettings->use_default_disable_pinned_message_notifications_) return _scopeNotificationSettings->disable_pinned_message_notifications_;
+    if (_summary->notificationSettings->use_default_disable_pinned_message_notifications_) return _scopeNotificationSettings->disable_pinned_message_notifications_;
 
-    return _notificationSettings->disable_pinned_message_notifications_;
+    return _summary->notificationSettings->disable_pinned_message_notifications_;
 }
 
 void Chat::setDisablePinnedMessageNotifications(bool disablePinnedMessageNotifications)
 {
-    if (_notificationSettings == nullptr) return;
+    if (_summary->notificationSettings == nullptr) return;
 
     auto settings = td_api::make_object<td_api::chatNotificationSettings>(
-                _notificationSettings->use_default_mute_for_,
-                _notificationSettings->mute_for_,
-                _notificationSettings->use_default_sound_,
-                _notificationSettings->sound_,
-                _notificationSettings->use_default_show_preview_,
-                _notificationSettings->show_preview_,
-                _notificationSettings->use_default_disable_pinned_message_notifications_,
-                _notificationSettings->disable_pinned_message_notifications_,
-                _notificationSettings->use_default_disable_mention_notifications_,
-                _notificationSettings->disable_mention_notifications_
+                _summary->notificationSettings->use_default_mute_for_,
+                _summary->notificationSettings->mute_for_,
+                _summary->notificationSettings->use_default_sound_,
+                _summary->notificationSettings->sound_,
+                _summary->notificationSettings->use_default_show_preview_,
+                _summary->notificationSettings->show_preview_,
+                _summary->notificationSettings->use_default_disable_pinned_message_notifications_,
+                _summary->notificationSettings->disable_pinned_message_notifications_,
+                _summary->notificationSettings->use_default_disable_mention_notifications_,
+                _summary->notificationSettings->disable_mention_notifications_
     );
     settings->use_default_disable_pinned_message_notifications_ = _scopeNotificationSettings->disable_pinned_message_notifications_ == disablePinnedMessageNotifications;
     settings->disable_pinned_message_notifications_ = disablePinnedMessageNotifications;
@@ -332,35 +274,35 @@ void Chat::setDisablePinnedMessageNotifications(bool disablePinnedMessageNotific
 
 bool Chat::getDefaultDisablePinnedMessageNotifications() const
 {
-    if (_notificationSettings == nullptr) return false;
+    if (_summary->notificationSettings == nullptr) return false;
 
-    return _scopeNotificationSettings->disable_pinned_message_notifications_ == _notificationSettings->disable_pinned_message_notifications_;
+    return _scopeNotificationSettings->disable_pinned_message_notifications_ == _summary->notificationSettings->disable_pinned_message_notifications_;
 }
 
 bool Chat::getDisableMentionNotifications() const
 {
-    if (_notificationSettings == nullptr) return 0;
+    if (_summary->notificationSettings == nullptr) return 0;
 
-    if (_notificationSettings->use_default_disable_mention_notifications_) return _scopeNotificationSettings->disable_mention_notifications_;
+    if (_summary->notificationSettings->use_default_disable_mention_notifications_) return _scopeNotificationSettings->disable_mention_notifications_;
 
-    return _notificationSettings->disable_mention_notifications_;
+    return _summary->notificationSettings->disable_mention_notifications_;
 }
 
 void Chat::setDisableMentionNotifications(bool disableMentionNotifications)
 {
-    if (_notificationSettings == nullptr) return;
+    if (_summary->notificationSettings == nullptr) return;
 
     auto settings = td_api::make_object<td_api::chatNotificationSettings>(
-                _notificationSettings->use_default_mute_for_,
-                _notificationSettings->mute_for_,
-                _notificationSettings->use_default_sound_,
-                _notificationSettings->sound_,
-                _notificationSettings->use_default_show_preview_,
-                _notificationSettings->show_preview_,
-                _notificationSettings->use_default_disable_pinned_message_notifications_,
-                _notificationSettings->disable_pinned_message_notifications_,
-                _notificationSettings->use_default_disable_mention_notifications_,
-                _notificationSettings->disable_mention_notifications_
+                _summary->notificationSettings->use_default_mute_for_,
+                _summary->notificationSettings->mute_for_,
+                _summary->notificationSettings->use_default_sound_,
+                _summary->notificationSettings->sound_,
+                _summary->notificationSettings->use_default_show_preview_,
+                _summary->notificationSettings->show_preview_,
+                _summary->notificationSettings->use_default_disable_pinned_message_notifications_,
+                _summary->notificationSettings->disable_pinned_message_notifications_,
+                _summary->notificationSettings->use_default_disable_mention_notifications_,
+                _summary->notificationSettings->disable_mention_notifications_
     );
     settings->use_default_disable_mention_notifications_ = _scopeNotificationSettings->disable_mention_notifications_ == disableMentionNotifications;
     settings->disable_mention_notifications_ = disableMentionNotifications;
@@ -369,37 +311,61 @@ void Chat::setDisableMentionNotifications(bool disableMentionNotifications)
 
 bool Chat::getDefaultDisableMentionNotifications() const
 {
-    if (_notificationSettings == nullptr) return false;
+    if (_summary->notificationSettings == nullptr) return false;
 
-    return _scopeNotificationSettings->disable_mention_notifications_ == _notificationSettings->disable_mention_notifications_;
+    return _scopeNotificationSettings->disable_mention_notifications_ == _summary->notificationSettings->disable_mention_notifications_;
 }
 
 qint64 Chat::getPinnedMessageId()
 {
-    if (_chat->pinned_message_id_ != 0 && !_messages.contains(_chat->pinned_message_id_)) {
-        getMessage(_chat->pinned_message_id_);
-    }
-
-    return _chat->pinned_message_id_;
+    return _summary->pinnedMessageId;
 }
 
 void Chat::setTelegramManager(shared_ptr<TelegramManager> manager)
 {
     _manager = manager;
 
-    connect(manager.get(), SIGNAL(updateChatReadInbox(td_api::updateChatReadInbox*)), this, SLOT(updateChatReadInbox(td_api::updateChatReadInbox*)));
-    connect(_manager.get(), SIGNAL(updateChatReadOutbox(td_api::updateChatReadOutbox*)), this, SLOT(updateChatReadOutbox(td_api::updateChatReadOutbox*)));
-    connect(_manager.get(), SIGNAL(messages(td_api::messages*)), this, SLOT(messages(td_api::messages*)));
+    connect(_manager.get(), SIGNAL(messages(quint64, td_api::messages*)), this, SLOT(messages(quint64, td_api::messages*)));
+    connect(_manager.get(), SIGNAL(error(quint64, td_api::error*)), this, SLOT(error(quint64, td_api::error*)));
+    connect(_manager.get(), SIGNAL(message(quint64, td_api::message*)), this, SLOT(messageSent(quint64, td_api::message*)));
     connect(_manager.get(), SIGNAL(updateNewMessage(td_api::updateNewMessage*)), this, SLOT(updateNewMessage(td_api::updateNewMessage*)));
-    connect(_manager.get(), SIGNAL(updateChatTitle(td_api::updateChatTitle*)), this, SLOT(updateChatTitle(td_api::updateChatTitle*)));
     connect(_manager.get(), SIGNAL(updateDeleteMessages(td_api::updateDeleteMessages*)), this, SLOT(updateDeleteMessages(td_api::updateDeleteMessages*)));
+    connect(_manager.get(), SIGNAL(updateMessageSendSucceeded(td_api::updateMessageSendSucceeded*)), this, SLOT(updateMessageSendSucceeded(td_api::updateMessageSendSucceeded*)));
+    connect(_manager.get(), SIGNAL(updateMessageContent(td_api::updateMessageContent*)), this, SLOT(updateMessageContent(td_api::updateMessageContent*)));
     connect(_manager.get(), SIGNAL(updateBasicGroupFullInfo(td_api::updateBasicGroupFullInfo*)), this, SLOT(updateBasicGroupFullInfo(td_api::updateBasicGroupFullInfo*)));
     connect(_manager.get(), SIGNAL(updateSupergroupFullInfo(td_api::updateSupergroupFullInfo*)), this, SLOT(updateSupergroupFullInfo(td_api::updateSupergroupFullInfo*)));
-    connect(_manager.get(), SIGNAL(updateSecretChat(td_api::updateSecretChat*)), this, SLOT(updateSecretChat(td_api::updateSecretChat*)));
     connect(_manager.get(), SIGNAL(myIdChanged(qint32)), this, SIGNAL(isSelfChanged()));
-    connect(_manager.get(), SIGNAL(updateChatNotificationSettings(td_api::updateChatNotificationSettings*)), this, SLOT(updateChatNotificationSettings(td_api::updateChatNotificationSettings*)));
-    connect(_manager.get(), SIGNAL(updateChatPinnedMessage(td_api::updateChatPinnedMessage*)), this, SLOT(updateChatPinnedMessage(td_api::updateChatPinnedMessage*)));
-    connect(_manager.get(), SIGNAL(message(td_api::message*)), this, SLOT(gotMessage(td_api::message*)));
+    connect(_manager.get(), SIGNAL(connectedChanged(bool)), this, SLOT(onConnectedChanged(bool)));
+}
+
+void Chat::activate()
+{
+    if (_isActivated) return;
+    _isActivated = true;
+
+    if (_summary->pinnedMessageId != 0) resolveReplyTargets({_summary->pinnedMessageId});
+
+    loadOutgoingMessages();
+    if (_isLatestLoaded) showOutgoingMessages();
+    flushOutgoingMessages();
+}
+
+void Chat::setSummary(ChatSummary *summary)
+{
+    _summary = summary;
+    _chatType = _summary->getChatType();
+}
+
+void Chat::setExpiryWheel(ExpiryWheel *expiryWheel)
+{
+    _expiryWheel = expiryWheel;
+    connect(_expiryWheel, SIGNAL(messagesExpired(qint64,QVector<qint64>)), this, SLOT(messagesExpired(qint64,QVector<qint64>)));
+}
+
+void Chat::setTextLayoutService(TextLayoutService *textLayoutService)
+{
+    _textLayoutService = textLayoutService;
+    connect(_textLayoutService, SIGNAL(measured(qint64,quint32,QVector<qint64>,QVector<int>)), this, SLOT(textHeightsMeasured(qint64,quint32,QVector<qint64>,QVector<int>)));
 }
 
 void Chat::setUsers(shared_ptr<Users> users)
@@ -423,106 +389,32 @@ QVariant Chat::data(const QModelIndex &index, int role) const
     if (rowCount() <= 0 || index.row() < 0 || index.row() >= rowCount()) return QVariant();
 
     auto message = _messages[_message_ids[index.row()]];
+    auto &display = message->getDisplay();
     switch (role) {
     case MessageRoles::TypeRole:
-        return getChatType();
+        return _chatType;
     case MessageRoles::IdRole:
         return QVariant::fromValue(message->getId());
     case MessageRoles::MessageRole:
-        if (message->getType() == "messageChatDeleteMember") {
-            return tr("%1 left").arg(_users->getUser(message->getDeleteMemberId())->getName());
-        } else if (message->getType() == "messageChatAddMembers") {
-            auto newUsers = message->getAddMembersIds();
-            for(auto userId: newUsers) {
-                return tr("%1 joined").arg(_users->getUser(userId)->getName());
-            }
-        }
-        return message->getText();
+        return display.text;
     case MessageRoles::MessageTypeRole:
-        return message->getType();
+        return display.type;
     case MessageRoles::ReceivedRole:
         return QVariant::fromValue(message->received());
     case MessageRoles::ReplyMessageIdRole:
         return message->replyMessageId();
     case MessageRoles::IsForwardedRole:
-        return message->getForwardedInfo() != nullptr;
+        return message->isForwarded();
     case MessageRoles::ForwardUserRole:
-    {
-        if (message->getForwardedInfo() != nullptr && message->getForwardedInfo()->origin_->get_id() == td_api::messageForwardOriginUser::ID) {
-            return static_cast<const td_api::messageForwardOriginUser&>(*message->getForwardedInfo()->origin_).sender_user_id_;
-        }
-        return 0;
-    }
+        return display.forwardUserId;
     case MessageRoles::ForwardUsernameRole:
-    {
-        if (message->getForwardedInfo() != nullptr && message->getForwardedInfo()->origin_->get_id() == td_api::messageForwardOriginHiddenUser::ID) {
-            return QString::fromStdString(static_cast<const td_api::messageForwardOriginHiddenUser&>(*message->getForwardedInfo()->origin_).sender_name_);
-        }
-        return "";
-    }
+        return display.forwardUsername;
     case MessageRoles::ForwardChannelRole:
-    {
-        if (message->getForwardedInfo() != nullptr && message->getForwardedInfo()->origin_->get_id() == td_api::messageForwardOriginChannel::ID) {
-            return static_cast<const td_api::messageForwardOriginChannel&>(*message->getForwardedInfo()->origin_).chat_id_;
-        }
-        return 0;
-    }
+        return display.forwardChannelId;
     case MessageRoles::FileRole:
-    {
-        switch (message->getContentType()) {
-        case td_api::messagePhoto::ID:
-        {
-            auto photo = message->getPhoto();
-            QQmlEngine::setObjectOwnership(photo, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(photo);
-        }
-        case td_api::messageSticker::ID:
-        {
-            auto sticker = message->getSticker();
-            QQmlEngine::setObjectOwnership(sticker, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(sticker);
-        }
-        case td_api::messageVideo::ID:
-        {
-            auto video = message->getVideo();
-            QQmlEngine::setObjectOwnership(video, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(video);
-        }
-        case td_api::messageDocument::ID:
-        {
-            auto document = message->getDocument();
-            QQmlEngine::setObjectOwnership(document, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(document);
-        }
-        case td_api::messageAudio::ID:
-        {
-            auto audio = message->getAudio();
-            QQmlEngine::setObjectOwnership(audio, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(audio);
-        }
-        case td_api::messageAnimation::ID:
-        {
-            auto animation = message->getAnimation();
-            QQmlEngine::setObjectOwnership(animation, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(animation);
-        }
-        case td_api::messageVoiceNote::ID:
-        {
-            auto voiceNote = message->getVoiceNote();
-            QQmlEngine::setObjectOwnership(voiceNote, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(voiceNote);
-        }
-        case td_api::messageVideoNote::ID:
-        {
-            auto videoNote = message->getVideoNote();
-            QQmlEngine::setObjectOwnership(videoNote, QQmlEngine::CppOwnership);
-            return QVariant::fromValue(videoNote);
-        }
-        }
-        break;
-     }
+        return message->getFile();
     case MessageRoles::TimeRole:
-        return message->getFormattedTimestamp();
+        return display.time;
     case MessageRoles::AuthorIdRole:
         return message->getSenderUserId();
     case MessageRoles::EditedRole:
@@ -550,17 +442,14 @@ QVariant Chat::data(const QModelIndex &index, int role) const
     case MessageRoles::HasWebPageRole:
         return message->hasWebPage();
     case MessageRoles::WebPageRole:
-    {
-        auto webPage = message->getWebPage();
-        QQmlEngine::setObjectOwnership(webPage, QQmlEngine::CppOwnership);
-        return QVariant::fromValue(webPage);
-    }
+        return message->getWebPage();
     case MessageRoles::PollRole:
-    {
-        auto poll = message->getPoll();
-        QQmlEngine::setObjectOwnership(poll, QQmlEngine::CppOwnership);
-        return QVariant::fromValue(poll);
-    }
+        return message->getPoll();
+    case MessageRoles::ReplySummaryRole:
+        if (message->replyMessageId() == 0) return QVariantMap();
+        return getReplySummary(message->replyMessageId());
+    case MessageRoles::TextHeightRole:
+        return _textHeights.value(message->getId(), 0);
     default:
         return QVariant();
     }
@@ -593,53 +482,368 @@ QHash<int, QByteArray> Chat::roleNames() const
     roles[HasWebPageRole] = "hasWebPage";
     roles[WebPageRole] = "webPage";
     roles[PollRole] = "poll";
+    roles[ReplySummaryRole] = "replySummary";
+    roles[TextHeightRole] = "textHeight";
     return roles;
 }
 
-td_api::chat *Chat::getChat()
+int Chat::getMessageIndex(qint64 messageId)
 {
-    return _chat;
+    auto it = _messageKeys.constFind(messageId);
+    if (it == _messageKeys.constEnd()) return -1;
+
+    return static_cast<int>(it.value() - _firstKey);
 }
 
-int Chat::getMessageIndex(qint64 messageId)
+int Chat::findMessageRow(qint64 messageId) const
+{
+    return std::lower_bound(_message_ids.begin(), _message_ids.end(), messageId, std::greater<qint64>()) - _message_ids.begin();
+}
+
+QVariant Chat::getMessageData(qint64 messageId, QString roleName)
+{
+    auto index = getMessageIndex(messageId);
+    if (index == -1) return QVariant();
+
+    return data(createIndex(index, 0), roleNames().key(roleName.toUtf8()));
+}
+
+QVariantMap Chat::getReplySummary(qint64 messageId) const
+{
+    auto message = _messages.value(messageId, nullptr);
+    if (message != nullptr) return createReplySummary(message);
+
+    auto summary = _replySummaries.object(messageId);
+    if (summary != nullptr) return *summary;
+
+    return QVariantMap();
+}
+
+QVariantMap Chat::createReplySummary(Message *message) const
+{
+    auto &display = message->getDisplay();
+
+    QVariantMap summary;
+    summary["authorId"] = message->getSenderUserId();
+    summary["messageType"] = display.type;
+    summary["messageText"] = display.text.simplified().left(REPLY_TEXT_LENGTH);
+    return summary;
+}
+
+QVariantMap Chat::createReplySummary(td_api::message *message) const
 {
-    if(rowCount() <= 0) return -1;
+    auto contentTypeId = message->content_ == nullptr ? 0 : message->content_->get_id();
 
-    auto it = std::find(_message_ids.begin(), _message_ids.end(), messageId);
+    QVariantMap summary;
+    summary["authorId"] = message->sender_user_id_;
+    summary["messageType"] = Message::formatType(contentTypeId);
+    summary["messageText"] = Message::formatText(message->content_.get(), message->sender_user_id_, _users).simplified().left(REPLY_TEXT_LENGTH);
+    return summary;
+}
+
+void Chat::resolveReplyTargets(const QVector<qint64> &messageIds)
+{
+    std::vector<std::int64_t> unknownIds;
+    for (auto messageId: messageIds) {
+        if (_messages.contains(messageId) || _replySummaries.contains(messageId) || _pendingReplyIds.contains(messageId)) continue;
 
-    if (it != _message_ids.end()) {
-        return std::distance(_message_ids.begin(), it);
+        _pendingReplyIds.insert(messageId);
+        unknownIds.push_back(messageId);
     }
+    if (unknownIds.empty()) return;
+
+    _replyRequests[_manager->sendQuery(new td_api::getMessages(getId(), unknownIds))] = unknownIds;
+}
+
+void Chat::replyTargetsReceived(const std::vector<std::int64_t> &messageIds, td_api::messages *messages)
+{
+    QSet<qint64> resolvedIds;
+    for (size_t i = 0; i < messageIds.size(); ++i) {
+        _pendingReplyIds.remove(messageIds[i]);
+        if (i >= messages->messages_.size() || messages->messages_[i] == nullptr) {
+            _replySummaries.insert(messageIds[i], new QVariantMap());
+            continue;
+        }
 
-    return -1;
+        _replySummaries.insert(messageIds[i], new QVariantMap(createReplySummary(messages->messages_[i].get())));
+        resolvedIds.insert(messageIds[i]);
+        emit replySummaryChanged(messageIds[i]);
+    }
+    if (resolvedIds.isEmpty()) return;
+
+    int first = -1;
+    for (int row = 0; row <= _message_ids.size(); ++row) {
+        bool resolved = row < _message_ids.size() && resolvedIds.contains(_messages[_message_ids[row]]->replyMessageId());
+        if (resolved && first == -1) {
+            first = row;
+        } else if (!resolved && first != -1) {
+            emit dataChanged(createIndex(first, 0), createIndex(row - 1, 0), {ReplySummaryRole});
+            first = -1;
+        }
+    }
 }
 
 td_api::message *Chat::getLastMessage()
 {
-    return _chat->last_message_.get();
+    return _summary->lastMessage.get();
 }
 
 void Chat::setLastMessage(td_api::object_ptr<td_api::message> lastMessage)
 {
-    _chat->last_message_ = move(lastMessage);
+    _summary->lastMessage = move(lastMessage);
 }
 
 void Chat::newMessage(td_api::object_ptr<td_api::message> message)
 {
     if (false == _messages.contains(message->id_)) {
-        beginInsertRows(QModelIndex(), rowCount(), rowCount());
-        auto newMessage = new Message();
-        newMessage->setTelegramManager(_manager);
-        newMessage->setUsers(_users);
-        newMessage->setFiles(_files);
-        newMessage->setMessage(message.release());
-        newMessage->setChatId(this->getId());
-        connect(newMessage, SIGNAL(contentChanged(qint64)), this, SLOT(onMessageContentChanged(qint64)));
-        connect(newMessage, SIGNAL(messageIdChanged(qint64,qint64)), this, SLOT(onMessageIdChanged(qint64,qint64)));
-        _messages[newMessage->getId()] = newMessage;
-        _message_ids.append(newMessage->getId());
+        insertMessages({createMessage(move(message))});
+    }
+}
+
+Message *Chat::createMessage(td_api::object_ptr<td_api::message> message)
+{
+    if (!_messagePool.isEmpty()) {
+        auto pooledMessage = _messagePool.takeLast();
+        pooledMessage->setMessage(std::move(message));
+        return pooledMessage;
+    }
+
+    auto newMessage = new Message();
+    newMessage->setTelegramManager(_manager);
+    newMessage->setUsers(_users);
+    newMessage->setFiles(_files);
+    newMessage->setContentPool(&_contentPool);
+    newMessage->setMessage(std::move(message));
+    newMessage->setChatId(this->getId());
+    connect(newMessage, SIGNAL(contentChanged(qint64)), this, SLOT(onMessageContentChanged(qint64)));
+    connect(newMessage, SIGNAL(messageIdChanged(qint64,qint64)), this, SLOT(onMessageIdChanged(qint64,qint64)));
+    return newMessage;
+}
+
+void Chat::recycleMessage(Message *message)
+{
+    message->clear();
+    if (_messagePool.size() >= _maxPooledMessages) {
+        delete message;
+        return;
+    }
+
+    _messagePool.append(message);
+}
+
+void Chat::setPoolingEnabled(bool enabled)
+{
+    _maxPooledMessages = enabled ? MAX_POOLED_MESSAGES : 0;
+    _contentPool.setCapacity(enabled ? MAX_POOLED_CONTENTS : 0);
+    while (_messagePool.size() > _maxPooledMessages) delete _messagePool.takeLast();
+}
+
+void Chat::insertMessages(QVector<Message*> messages)
+{
+    std::sort(messages.begin(), messages.end(), [](Message* a, Message* b) { return a->getId() > b->getId(); });
+
+    bool pinnedMessageLoaded = false;
+    bool olderMessagesLoaded = false;
+    int i = 0;
+    while (i < messages.size()) {
+        int row = findMessageRow(messages[i]->getId());
+        int j = i + 1;
+        while (j < messages.size() && (row == _message_ids.size() || _message_ids[row] < messages[j]->getId())) ++j;
+
+        int count = j - i;
+        if (row > 0 && row == _message_ids.size()) olderMessagesLoaded = true;
+        beginInsertRows(QModelIndex(), row, row + count - 1);
+        _message_ids.insert(row, count, 0);
+        for (int k = i; k < j; ++k) {
+            _messages[messages[k]->getId()] = messages[k];
+            _message_ids[row + k - i] = messages[k]->getId();
+            if (messages[k]->getId() == _summary->pinnedMessageId) pinnedMessageLoaded = true;
+        }
+        if (row < _message_ids.size() - row - count) {
+            _firstKey -= count;
+            updateMessageKeys(0, row + count);
+        } else {
+            updateMessageKeys(row, _message_ids.size());
+        }
         endInsertRows();
-        if (newMessage->getId() == _chat->pinned_message_id_) emit pinnedMessageIdChanged();
+
+        i = j;
+    }
+
+    if (_oldestLoadedMessageId == 0 || _message_ids.last() < _oldestLoadedMessageId) {
+        _oldestLoadedMessageId = _message_ids.last();
+    }
+    if (_summary->lastMessage == nullptr || _message_ids.first() >= _summary->lastMessage->id_) {
+        _isLatestLoaded = true;
+    }
+
+    QVector<qint64> replyIds;
+    for (auto message: messages) {
+        scheduleExpiry(message);
+
+        auto replyId = message->replyMessageId();
+        if (replyId == 0) continue;
+
+        if (!_messages.contains(replyId)) replyIds.append(replyId);
+    }
+    resolveReplyTargets(replyIds);
+    measureMessages(messages);
+    trimMessages(!olderMessagesLoaded || _gapEnd != 0);
+
+    if (pinnedMessageLoaded) emit pinnedMessageIdChanged();
+    if (_isLatestLoaded) showOutgoingMessages();
+}
+
+void Chat::removeMessageRows(int first, int count)
+{
+    beginRemoveRows(QModelIndex(), first, first + count - 1);
+    for (int row = first; row < first + count; ++row) {
+        _messageKeys.remove(_message_ids[row]);
+        _textHeights.remove(_message_ids[row]);
+        recycleMessage(_messages.take(_message_ids[row]));
+    }
+    _message_ids.remove(first, count);
+    if (first < _message_ids.size() - first) {
+        _firstKey += count;
+        updateMessageKeys(0, first);
+    } else {
+        updateMessageKeys(first, _message_ids.size());
+    }
+    clipLoadedRanges();
+    endRemoveRows();
+}
+
+void Chat::removeMessageIndexes(QVector<int> rows)
+{
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    int i = 0;
+    while (i < rows.size()) {
+        int j = i + 1;
+        while (j < rows.size() && rows[j] == rows[j - 1] - 1) ++j;
+        removeMessageRows(rows[j - 1], j - i);
+        i = j;
+    }
+}
+
+void Chat::measureMessages(const QVector<Message*> &messages)
+{
+    if (_textLayoutService == nullptr || _textWidth <= 0) return;
+
+    QVector<qint64> messageIds;
+    QStringList texts;
+    for (auto message: messages) {
+        if (message->getDisplay().text.isEmpty()) continue;
+        if (message->getContentType() == td_api::messageText::ID && message->replyMessageId() == 0 && !message->hasWebPage()) continue;
+
+        messageIds.append(message->getId());
+        texts.append(message->getDisplay().text);
+    }
+    _textLayoutService->measure(getId(), _textLayoutRevision, _textFont, _textWidth, messageIds, texts);
+}
+
+void Chat::setTextLayout(QFont font, qreal width)
+{
+    if (font == _textFont && width == _textWidth) return;
+
+    _textFont = font;
+    _textWidth = width;
+    ++_textLayoutRevision;
+    _textHeights.clear();
+    measureMessages(_messages.values().toVector());
+    emit textLayoutChanged();
+}
+
+qreal Chat::getTextLayoutWidth() const
+{
+    return _textWidth;
+}
+
+void Chat::textHeightsMeasured(qint64 chatId, quint32 revision, QVector<qint64> messageIds, QVector<int> heights)
+{
+    if (chatId != this->getId() || revision != _textLayoutRevision) return;
+
+    QVector<int> rows;
+    for (int i = 0; i < messageIds.size(); ++i) {
+        auto index = getMessageIndex(messageIds[i]);
+        if (-1 == index) continue;
+
+        _textHeights[messageIds[i]] = heights[i];
+        rows.append(index);
+    }
+    std::sort(rows.begin(), rows.end());
+
+    int i = 0;
+    while (i < rows.size()) {
+        int j = i + 1;
+        while (j < rows.size() && rows[j] <= rows[j - 1] + 1) ++j;
+        emit dataChanged(createIndex(rows[i], 0), createIndex(rows[j - 1], 0), {TextHeightRole});
+        i = j;
+    }
+}
+
+void Chat::scheduleExpiry(Message *message)
+{
+    if (_expiryWheel == nullptr || message->getTtl() == 0 || message->getTtlExpiresIn() >= message->getTtl()) return;
+
+    _expiryWheel->schedule(getId(), message->getId(), message->getTtlExpiresIn());
+}
+
+void Chat::addLoadedRange(qint64 from, qint64 to)
+{
+    if (from > to) std::swap(from, to);
+
+    auto it = _loadedRanges.upperBound(from);
+    if (it != _loadedRanges.begin() && std::prev(it).value() >= from) {
+        --it;
+        from = it.key();
+        to = std::max(to, it.value());
+        it = _loadedRanges.erase(it);
+    }
+    while (it != _loadedRanges.end() && it.key() <= to) {
+        to = std::max(to, it.value());
+        it = _loadedRanges.erase(it);
+    }
+    _loadedRanges.insert(from, to);
+}
+
+void Chat::clipLoadedRanges()
+{
+    if (_message_ids.isEmpty()) {
+        _loadedRanges.clear();
+        return;
+    }
+
+    while (!_loadedRanges.isEmpty() && _loadedRanges.first() < _message_ids.last()) _loadedRanges.erase(_loadedRanges.begin());
+    if (!_loadedRanges.isEmpty() && _loadedRanges.firstKey() < _message_ids.last()) {
+        _loadedRanges.insert(_message_ids.last(), _loadedRanges.take(_loadedRanges.firstKey()));
+    }
+
+    while (!_loadedRanges.isEmpty() && _loadedRanges.lastKey() > _message_ids.first()) _loadedRanges.erase(std::prev(_loadedRanges.end()));
+    if (!_loadedRanges.isEmpty() && _loadedRanges.last() > _message_ids.first()) {
+        _loadedRanges.last() = _message_ids.first();
+    }
+}
+
+void Chat::trimMessages(bool keepNewest)
+{
+    int excess = _message_ids.size() - MAX_LOADED_MESSAGES;
+    if (excess <= 0) return;
+
+    if (keepNewest) {
+        removeMessageRows(MAX_LOADED_MESSAGES, excess);
+        _isOldestLoaded = false;
+    } else {
+        removeMessageRows(0, excess);
+        _isLatestLoaded = false;
+    }
+}
+
+void Chat::updateMessageKeys(int from, int to)
+{
+    for (int row = from; row < to; ++row) {
+        _messageKeys[_message_ids[row]] = _firstKey + row;
     }
 }
 
@@ -665,30 +869,132 @@ std::vector<string> Chat::splitToVector(QString string, QString separator)
 
 void Chat::sendMessage(QString message, qint64 replyToMessageId)
 {
-    auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    OutgoingMessage outgoing;
+    outgoing.localMessageId = ++_lastLocalMessageId;
+    outgoing.text = message;
+    outgoing.replyToMessageId = replyToMessageId;
+    outgoing.queryId = 0;
+    _outgoingMessages.append(outgoing);
+    saveOutgoingMessages();
 
-    if (replyToMessageId != 0) {
-        sendMessage->reply_to_message_id_ = replyToMessageId;
+    if (_isLatestLoaded) showOutgoingMessages();
+    flushOutgoingMessages();
+}
+
+void Chat::loadOutgoingMessages()
+{
+    QSettings settings;
+    for (auto value: settings.value(QString("outgoingMessages/%1").arg(getId())).toList()) {
+        auto outgoingMessage = value.toMap();
+
+        OutgoingMessage outgoing;
+        outgoing.localMessageId = ++_lastLocalMessageId;
+        outgoing.text = outgoingMessage["text"].toString();
+        outgoing.replyToMessageId = outgoingMessage["replyToMessageId"].toLongLong();
+        outgoing.queryId = 0;
+        _outgoingMessages.append(outgoing);
     }
+}
 
-    auto messageContent = td_api::make_object<td_api::inputMessageText>();
-    messageContent->text_ = td_api::make_object<td_api::formattedText>();
-    messageContent->text_->text_ = message.toStdString();
-    messageContent->disable_web_page_preview_ = false;
-    sendMessage->input_message_content_ = std::move(messageContent);
+void Chat::saveOutgoingMessages()
+{
+    QVariantList outgoingMessages;
+    for (auto &outgoing: _outgoingMessages) {
+        if (outgoing.queryId != 0) continue;
 
-    _manager->sendQuery(sendMessage);
+        QVariantMap outgoingMessage;
+        outgoingMessage["text"] = outgoing.text;
+        outgoingMessage["replyToMessageId"] = outgoing.replyToMessageId;
+        outgoingMessages.append(outgoingMessage);
+    }
+
+    QSettings settings;
+    auto key = QString("outgoingMessages/%1").arg(getId());
+    if (outgoingMessages.isEmpty()) settings.remove(key);
+    else settings.setValue(key, outgoingMessages);
 }
 
-void Chat::getMoreChatHistory()
+void Chat::showOutgoingMessages()
+{
+    QVector<Message*> echoes;
+    for (auto &outgoing: _outgoingMessages) {
+        if (!_messages.contains(outgoing.localMessageId)) echoes.append(createMessage(createLocalMessage(outgoing)));
+    }
+
+    if (!echoes.isEmpty()) insertMessages(echoes);
+}
+
+void Chat::flushOutgoingMessages()
+{
+    if (!_manager->isConnected()) return;
+
+    bool sent = false;
+    for (auto &outgoing: _outgoingMessages) {
+        if (outgoing.queryId != 0) continue;
+
+        auto sendMessage = new td_api::sendMessage();
+        sendMessage->chat_id_ = _summary->getId();
+        sendMessage->reply_to_message_id_ = outgoing.replyToMessageId;
+
+        auto messageContent = td_api::make_object<td_api::inputMessageText>();
+        messageContent->text_ = td_api::make_object<td_api::formattedText>();
+        messageContent->text_->text_ = outgoing.text.toStdString();
+        messageContent->disable_web_page_preview_ = false;
+        sendMessage->input_message_content_ = std::move(messageContent);
+
+        outgoing.queryId = _manager->sendQuery(sendMessage);
+        sent = true;
+    }
+
+    if (sent) saveOutgoingMessages();
+}
+
+void Chat::messageSent(quint64 id, td_api::message *message)
+{
+    if (message->chat_id_ != getId()) return;
+
+    for (int i = 0; i < _outgoingMessages.size(); ++i) {
+        if (_outgoingMessages[i].queryId != id) continue;
+
+        auto echo = _messages.value(_outgoingMessages.takeAt(i).localMessageId, nullptr);
+        if (echo == nullptr) return;
+
+        if (_messages.contains(message->id_)) removeMessageRows(getMessageIndex(echo->getId()), 1);
+        else echo->updateRecord(message);
+        return;
+    }
+}
+
+td_api::object_ptr<td_api::message> Chat::createLocalMessage(const OutgoingMessage &outgoing) const
 {
-    auto min = std::min_element(_message_ids.begin(), _message_ids.end());
+    auto message = td_api::make_object<td_api::message>();
+    message->id_ = outgoing.localMessageId;
+    message->sender_user_id_ = _manager->getMyId();
+    message->chat_id_ = getId();
+    message->sending_state_ = td_api::make_object<td_api::messageSendingStatePending>();
+    message->is_outgoing_ = true;
+    message->date_ = QDateTime::currentDateTime().toTime_t();
+    message->reply_to_message_id_ = outgoing.replyToMessageId;
+
+    auto content = td_api::make_object<td_api::messageText>();
+    content->text_ = td_api::make_object<td_api::formattedText>();
+    content->text_->text_ = outgoing.text.toStdString();
+    message->content_ = std::move(content);
 
-    if (_message_ids.end() != min) {
-        auto index = std::distance(_message_ids.begin(), min);
+    return message;
+}
 
-        this->getChatHistory(_message_ids[index]);
+void Chat::getMoreChatHistory()
+{
+    if (!_isOldestLoaded && !_message_ids.isEmpty()) {
+        this->getChatHistory(_message_ids.last(), _historyPageSize, _message_ids.last() > _oldestLoadedMessageId);
+    }
+}
+
+void Chat::getNewerChatHistory()
+{
+    if (!_isLatestLoaded && !_message_ids.isEmpty()) {
+        this->getChatHistory(_message_ids.first(), _historyPageSize, true, 1 - _historyPageSize);
     }
 }
 
@@ -701,13 +1007,30 @@ qint64 Chat::getAuthorByIndex(qint32 index)
 
 void Chat::setMessageAsRead(qint64 messageId)
 {
-    _manager->sendQuery(new td_api::viewMessages(this->getId(), {messageId}, false));
+    if (messageId <= _lastReadInboxMessageId || messageId > LOCAL_MESSAGE_ID_BASE) return;
+    if (std::find(_viewedMessages.begin(), _viewedMessages.end(), messageId) != _viewedMessages.end()) return;
+
+    _viewedMessages.push_back(messageId);
+    if (!_viewedMessagesTimer.isActive()) _viewedMessagesTimer.start();
+
+    auto message = _messages.value(messageId, nullptr);
+    if (_expiryWheel != nullptr && message != nullptr && message->getTtl() > 0 && message->received()) {
+        _expiryWheel->schedule(getId(), messageId, message->getTtl());
+    }
+}
+
+void Chat::flushViewedMessages()
+{
+    if (_viewedMessages.empty()) return;
+
+    _manager->sendQuery(new td_api::viewMessages(this->getId(), move(_viewedMessages), false));
+    _viewedMessages.clear();
 }
 
 void Chat::sendPhoto(QString path, qint64 replyToMessageId)
 {
     auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    sendMessage->chat_id_ = _summary->getId();
 
     if (replyToMessageId != 0) {
         sendMessage->reply_to_message_id_ = replyToMessageId;
@@ -726,7 +1049,7 @@ void Chat::sendPhoto(QString path, qint64 replyToMessageId)
 void Chat::sendFile(QString path, qint64 replyToMessageId)
 {
     auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    sendMessage->chat_id_ = _summary->getId();
 
     if (replyToMessageId != 0) {
         sendMessage->reply_to_message_id_ = replyToMessageId;
@@ -745,7 +1068,7 @@ void Chat::sendFile(QString path, qint64 replyToMessageId)
 void Chat::sendMusic(QString path, qint64 replyToMessageId)
 {
     auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    sendMessage->chat_id_ = _summary->getId();
 
     if (replyToMessageId != 0) {
         sendMessage->reply_to_message_id_ = replyToMessageId;
@@ -764,7 +1087,7 @@ void Chat::sendMusic(QString path, qint64 replyToMessageId)
 void Chat::sendVideo(QString path, qint64 replyToMessageId)
 {
     auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    sendMessage->chat_id_ = _summary->getId();
 
     if (replyToMessageId != 0) {
         sendMessage->reply_to_message_id_ = replyToMessageId;
@@ -783,7 +1106,7 @@ void Chat::sendVideo(QString path, qint64 replyToMessageId)
 void Chat::sendPoll(QString question, QStringList options, bool anonymous, bool multipleAnswers, bool quizMode, int validAnswer = -1)
 {
     auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    sendMessage->chat_id_ = _summary->getId();
 
     auto poll = td_api::make_object<td_api::inputMessagePoll>();
     poll->question_ = question.toStdString();
@@ -805,7 +1128,7 @@ void Chat::sendPoll(QString question, QStringList options, bool anonymous, bool
 void Chat::sendVoiceNote(QString path, QString waveform, qint64 duration, qint64 replyToMessageId)
 {
     auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    sendMessage->chat_id_ = _summary->getId();
 
     if (replyToMessageId != 0) {
         sendMessage->reply_to_message_id_ = replyToMessageId;
@@ -826,7 +1149,7 @@ void Chat::sendVoiceNote(QString path, QString waveform, qint64 duration, qint64
 void Chat::sendSticker(qint32 fileId, qint64 replyToMessageId)
 {
     auto sendMessage = new td_api::sendMessage();
-    sendMessage->chat_id_ = _chat->id_;
+    sendMessage->chat_id_ = _summary->getId();
 
     if (replyToMessageId != 0) {
         sendMessage->reply_to_message_id_ = replyToMessageId;
@@ -845,18 +1168,25 @@ void Chat::sendSticker(qint32 fileId, qint64 replyToMessageId)
 
 void Chat::sendForwardedMessages(QStringList forwardedMessages, qint64 forwardedFrom)
 {
-    forwardedMessages.sort();
-
+    std::vector<std::int64_t> messageIds;
     for (QString message : forwardedMessages) {
-        auto sendMessage = new td_api::sendMessage();
-        sendMessage->chat_id_ = _chat->id_;
+        messageIds.push_back(message.toLongLong());
+    }
+    if (messageIds.empty()) return;
 
-        auto messageContent = td_api::make_object<td_api::inputMessageForwarded>();
-        messageContent->from_chat_id_ = forwardedFrom;
-        messageContent->message_id_ = message.toLongLong();
-        sendMessage->input_message_content_ = std::move(messageContent);
+    std::sort(messageIds.begin(), messageIds.end());
+    messageIds.erase(std::unique(messageIds.begin(), messageIds.end()), messageIds.end());
+
+    for (size_t i = 0; i < messageIds.size(); i += FORWARD_BATCH_SIZE) {
+        auto forwardMessages = new td_api::forwardMessages();
+        forwardMessages->chat_id_ = _summary->getId();
+        forwardMessages->from_chat_id_ = forwardedFrom;
+        forwardMessages->message_ids_.assign(messageIds.begin() + i, messageIds.begin() + std::min(i + FORWARD_BATCH_SIZE, messageIds.size()));
+        forwardMessages->as_album_ = false;
+        forwardMessages->send_copy_ = false;
+        forwardMessages->remove_caption_ = false;
 
-        _manager->sendQuery(sendMessage);
+        _manager->sendQuery(forwardMessages);
     }
 }
 
@@ -867,14 +1197,14 @@ void Chat::open(QString path)
 
 void Chat::deleteMessage(qint64 messageId)
 {
-    _manager->sendQuery(new td_api::deleteMessages(_chat->id_, std::vector<qint64>(1, messageId), true));
+    _manager->sendQuery(new td_api::deleteMessages(_summary->getId(), std::vector<qint64>(1, messageId), true));
 
 }
 
 void Chat::editMessageText(qint64 messageId, QString messageText)
 {
     auto editMessage = new td_api::editMessageText();
-    editMessage->chat_id_ = _chat->id_;
+    editMessage->chat_id_ = _summary->getId();
     editMessage->message_id_ = messageId;
 
     auto messageContent = td_api::make_object<td_api::inputMessageText>();
@@ -890,7 +1220,7 @@ void Chat::chose(qint64 messageId, QString indexes)
 {
     auto optionIds = splitToIntVector(indexes, ",");
     auto request = new td_api::setPollAnswer();
-    request->chat_id_ = _chat->id_;
+    request->chat_id_ = _summary->getId();
     request->message_id_ = messageId;
     request->option_ids_ = optionIds;
     _manager->sendQuery(request);
@@ -898,12 +1228,12 @@ void Chat::chose(qint64 messageId, QString indexes)
 
 void Chat::openSecretChat()
 {
-    _manager->sendQuery(new td_api::createNewSecretChat(static_cast<td_api::chatTypeSecret*>(_chat->type_.get())->secret_chat_id_));
+    _manager->sendQuery(new td_api::createNewSecretChat(_summary->getSecretChatId()));
 }
 
 void Chat::closeSecretChat()
 {
-    _manager->sendQuery(new td_api::closeSecretChat(static_cast<td_api::chatTypeSecret*>(_chat->type_.get())->secret_chat_id_));
+    _manager->sendQuery(new td_api::closeSecretChat(_summary->getSecretChatId()));
 }
 
 void Chat::clearHistory(bool deleteChat)
@@ -917,119 +1247,364 @@ void Chat::setTtl(qint32 ttl)
     _manager->sendQuery(new td_api::sendChatSetTtlMessage(getId(), ttl));
 }
 
-void Chat::getChatHistory(qint64 from_message, int limit, bool localOnly)
+void Chat::loadHistory(int limit)
+{
+    auto pageSize = std::max(HISTORY_PAGE_SIZE, std::min(limit, MAX_HISTORY_PAGE_SIZE));
+
+    if (!_isLatestLoaded && !_message_ids.isEmpty()) {
+        removeMessageRows(0, _message_ids.size());
+        _isLatestLoaded = true;
+        _isOldestLoaded = false;
+    }
+
+    getChatHistory(0, pageSize, _message_ids.isEmpty());
+}
+
+void Chat::prefetchHistory()
+{
+    if (_message_ids.isEmpty()) getChatHistory(0, HISTORY_PAGE_SIZE, true);
+}
+
+void Chat::trimToWarmPage()
+{
+    flushViewedMessages();
+
+    if (!_isLatestLoaded && !_message_ids.isEmpty()) {
+        removeMessageRows(0, _message_ids.size());
+        _isLatestLoaded = true;
+        _isOldestLoaded = false;
+    } else if (_message_ids.size() > WARM_PAGE_SIZE) {
+        removeMessageRows(WARM_PAGE_SIZE, _message_ids.size() - WARM_PAGE_SIZE);
+        _isOldestLoaded = false;
+    }
+
+    qDeleteAll(_messagePool);
+    _messagePool.clear();
+    _replySummaries.clear();
+    _historyPageSize = HISTORY_PAGE_SIZE;
+    _maxPooledMessages = MAX_POOLED_MESSAGES;
+    _jumpMessageId = 0;
+    _gapEnd = 0;
+}
+
+qint64 Chat::getMemoryUsage() const
+{
+    qint64 usage = sizeof(Chat);
+    for (auto message: _messages) {
+        usage += message->getMemoryUsage();
+    }
+
+    return usage;
+}
+
+void Chat::loadMissingMessages(int fromRow, int toRow)
 {
+    if (_message_ids.isEmpty()) return;
+
+    auto lastRow = _message_ids.size() - 1;
+    auto newestId = _message_ids[qBound(0, std::min(fromRow, toRow), lastRow)];
+    auto oldestId = _message_ids[qBound(0, std::max(fromRow, toRow), lastRow)];
+
+    auto it = _loadedRanges.lowerBound(oldestId);
+    if (it != _loadedRanges.begin()) --it;
+    for (; it != _loadedRanges.end() && it.key() <= newestId; ++it) {
+        if (it.key() > _message_ids.last() && it.key() >= oldestId) {
+            getChatHistory(it.key(), _historyPageSize);
+        }
+        if (it.value() < _message_ids.first() && it.value() >= oldestId && it.value() <= newestId) {
+            getChatHistory(it.value(), _historyPageSize, false, 1 - _historyPageSize);
+        }
+    }
+}
+
+void Chat::jumpToMessage(qint64 messageId)
+{
+    _jumpMessageId = messageId;
+    _jumpToNextMessage = false;
+    checkJumpTarget();
+
+    if (_jumpMessageId != 0) getChatHistory(messageId, HISTORY_PAGE_SIZE, false, -HISTORY_PAGE_SIZE / 2);
+}
+
+void Chat::jumpToFirstUnread()
+{
+    if (_lastReadInboxMessageId == 0) return;
+
+    _jumpMessageId = _lastReadInboxMessageId;
+    _jumpToNextMessage = true;
+    checkJumpTarget();
+
+    if (_jumpMessageId != 0) getChatHistory(_lastReadInboxMessageId, HISTORY_PAGE_SIZE, false, 2 - HISTORY_PAGE_SIZE);
+}
+
+void Chat::checkJumpTarget()
+{
+    if (_jumpMessageId == 0) return;
+
+    auto range = _loadedRanges.upperBound(_jumpMessageId);
+    if (range == _loadedRanges.begin() || std::prev(range).value() < _jumpMessageId) return;
+
+    auto row = findMessageRow(_jumpMessageId);
+    if (_jumpToNextMessage && row > 0 && _message_ids[row - 1] <= std::prev(range).value()) --row;
+    else if (_jumpToNextMessage && (row > 0 || !_isLatestLoaded)) return;
+
+    _jumpMessageId = 0;
+    if (row < _message_ids.size()) emit messageJumpReady(_message_ids[row]);
+}
+
+void Chat::getChatHistory(qint64 from_message, int limit, bool localOnly, int offset)
+{
+    for (auto &request: _historyRequests) {
+        if (request.fromMessageId == from_message && request.offset == offset && request.limit == limit && request.onlyLocal == localOnly) return;
+    }
+
     auto getChatHistoryQuery = new td_api::getChatHistory();
-    getChatHistoryQuery->chat_id_ = _chat->id_;
+    getChatHistoryQuery->chat_id_ = _summary->getId();
     getChatHistoryQuery->from_message_id_ = from_message;
-    getChatHistoryQuery->offset_ = 0;
+    getChatHistoryQuery->offset_ = offset;
     getChatHistoryQuery->limit_ = limit;
     getChatHistoryQuery->only_local_ = localOnly;
 
-    _manager->sendQuery(getChatHistoryQuery);
+    _historyRequests[_manager->sendQuery(getChatHistoryQuery)] = {from_message, offset, limit, localOnly};
 }
 
-void Chat::getMessage(qint64 messageId)
+void Chat::historyReceived(const HistoryRequest &request, int count)
 {
-    _manager->sendQuery(new td_api::getMessage(getId(), messageId));
+    if (request.onlyLocal && !isOpen()) {
+        return;
+    } else if (request.onlyLocal && request.fromMessageId == 0) {
+        getChatHistory(0, request.limit, false, request.offset);
+    } else if (count > 0) {
+        _historyPageSize = std::min(_historyPageSize * 2, MAX_HISTORY_PAGE_SIZE);
+    } else if (request.onlyLocal) {
+        getChatHistory(request.fromMessageId, request.limit, false, request.offset);
+    } else if (request.offset < 0) {
+        if (request.fromMessageId == 0 || _summary->lastMessage == nullptr || (!_message_ids.isEmpty() && _message_ids.first() >= _summary->lastMessage->id_)) {
+            _isLatestLoaded = true;
+        }
+    } else {
+        _isOldestLoaded = true;
+    }
 }
 
 bool Chat::hasPhoto()
 {
-    return _chat->photo_ != nullptr;
+    return _summary->hasPhoto;
 }
 
 File* Chat::getSmallPhoto()
 {
-    auto file = _files->getFile(_smallPhotoId);
+    auto file = _files->getFile(_summary->smallPhotoId);
     if (file == nullptr) return nullptr;
     return file.get();
 }
 
 File* Chat::getBigPhoto()
 {
-    auto file = _files->getFile(_bigPhotoId);
+    auto file = _files->getFile(_summary->bigPhotoId);
     if (file == nullptr) return nullptr;
     return file.get();
 }
 
 void Chat::updateChatReadInbox(td_api::updateChatReadInbox *updateChatReadInbox)
 {
-    if (updateChatReadInbox->chat_id_ == this->getId()) {
-        setUnreadCount(updateChatReadInbox->unread_count_);
-        setLastReadInboxMessageId(updateChatReadInbox->last_read_inbox_message_id_);
-        emit dataChanged(createIndex(0, 0), createIndex(rowCount(), 0), {ReadRole});
-    }
+    emit unreadCountChanged(getId(), updateChatReadInbox->unread_count_);
+    auto oldMessageId = _lastReadInboxMessageId;
+    setLastReadInboxMessageId(updateChatReadInbox->last_read_inbox_message_id_);
+    updateReadRows(oldMessageId, _lastReadInboxMessageId);
 }
 
 void Chat::updateChatReadOutbox(td_api::updateChatReadOutbox *updateChatReadOutbox)
 {
-    if (updateChatReadOutbox->chat_id_ == this->getId()) {
-        setLastReadOutboxMessageId(updateChatReadOutbox->last_read_outbox_message_id_);
-        emit dataChanged(createIndex(0, 0), createIndex(rowCount(), 0), {ReadRole});
-    }
+    auto oldMessageId = _lastReadOutboxMessageId;
+    setLastReadOutboxMessageId(updateChatReadOutbox->last_read_outbox_message_id_);
+    updateReadRows(oldMessageId, _lastReadOutboxMessageId);
+}
+
+void Chat::updateReadRows(qint64 oldMessageId, qint64 newMessageId)
+{
+    if (oldMessageId == newMessageId) return;
+
+    auto first = findMessageRow(std::max(oldMessageId, newMessageId));
+    auto last = findMessageRow(std::min(oldMessageId, newMessageId)) - 1;
+    if (first <= last) emit dataChanged(createIndex(first, 0), createIndex(last, 0), {ReadRole});
 }
 
-void Chat::messages(td_api::messages *messages)
+void Chat::messages(quint64 id, td_api::messages *messages)
 {
+    if (_replyRequests.contains(id)) {
+        replyTargetsReceived(_replyRequests.take(id), messages);
+        return;
+    }
+
+    auto isHistoryRequest = _historyRequests.contains(id);
+    auto request = _historyRequests.take(id);
+    auto newestMessageId = _message_ids.isEmpty() ? 0 : _message_ids.first();
+
+    QVector<Message*> page;
+    int count = 0;
+    qint64 oldestMessageId = 0;
+    qint64 newestPageMessageId = request.fromMessageId;
     for(auto &message: messages->messages_) {
-        if (message.get() != nullptr && message->chat_id_ == this->getId()) {
-            this->newMessage(move(message));
-        }
+        if (message.get() == nullptr || message->chat_id_ != this->getId()) continue;
+
+        if (message->id_ != request.fromMessageId) ++count;
+        if (oldestMessageId == 0 || message->id_ < oldestMessageId) oldestMessageId = message->id_;
+        if (message->id_ > newestPageMessageId) newestPageMessageId = message->id_;
+        if (!_messages.contains(message->id_)) page.append(createMessage(move(message)));
+    }
+
+    if (isHistoryRequest && oldestMessageId != 0) addLoadedRange(oldestMessageId, newestPageMessageId);
+    if (!page.isEmpty()) insertMessages(page);
+    if (isHistoryRequest) {
+        checkJumpTarget();
+        if (!request.onlyLocal && request.offset == 0) fillHistoryGap(request, newestMessageId, oldestMessageId);
+        historyReceived(request, count);
+    }
+}
+
+void Chat::fillHistoryGap(const HistoryRequest &request, qint64 newestMessageId, qint64 oldestMessageId)
+{
+    if (request.fromMessageId == 0 && newestMessageId != 0 && oldestMessageId > newestMessageId) {
+        _gapEnd = newestMessageId;
+        getChatHistory(oldestMessageId, _historyPageSize);
+        return;
+    }
+    if (_gapEnd == 0 || request.fromMessageId <= _gapEnd) return;
+
+    if (oldestMessageId != 0 && oldestMessageId > _gapEnd) {
+        auto row = findMessageRow(_gapEnd);
+        if (row < _message_ids.size()) removeMessageRows(row, _message_ids.size() - row);
+        _isOldestLoaded = false;
+    }
+    _gapEnd = 0;
+}
+
+void Chat::error(quint64 id, td_api::error *error)
+{
+    Q_UNUSED(error)
+    _historyRequests.remove(id);
+
+    for (int i = 0; i < _outgoingMessages.size(); ++i) {
+        if (_outgoingMessages[i].queryId != id) continue;
+
+        auto row = getMessageIndex(_outgoingMessages.takeAt(i).localMessageId);
+        if (row != -1) removeMessageRows(row, 1);
+        return;
     }
 }
 
 void Chat::updateNewMessage(td_api::updateNewMessage *updateNewMessage)
 {
-    if (updateNewMessage->message_.get() != nullptr && updateNewMessage->message_->chat_id_ == this->getId()) {
+    if (updateNewMessage->message_.get() == nullptr || updateNewMessage->message_->chat_id_ != this->getId()) return;
+
+    auto message = _messages.value(updateNewMessage->message_->id_, nullptr);
+    if (message != nullptr) {
+        message->replaceMessage(move(updateNewMessage->message_));
+        return;
+    }
+
+    if (_isLatestLoaded) {
+        addLoadedRange(_message_ids.isEmpty() ? updateNewMessage->message_->id_ : _message_ids.first(), updateNewMessage->message_->id_);
         this->newMessage(move(updateNewMessage->message_));
     }
 }
 
+void Chat::onConnectedChanged(bool connected)
+{
+    if (connected) flushOutgoingMessages();
+}
+
 void Chat::updateChatTitle(td_api::updateChatTitle *updateChatTitle)
 {
-    if (updateChatTitle->chat_id_ == getId()) {
-        _chat->title_ = updateChatTitle->title_;
-        emit titleChanged();
-    }
+    Q_UNUSED(updateChatTitle)
+    emit titleChanged();
+}
+
+void Chat::updateChatPhoto(td_api::updateChatPhoto *updateChatPhoto)
+{
+    Q_UNUSED(updateChatPhoto)
+    emit chatPhotoChanged(getId());
 }
 
 void Chat::updateDeleteMessages(td_api::updateDeleteMessages *updateDeleteMessages)
 {
     if (updateDeleteMessages->chat_id_ == this->getId()) {
+        QVector<int> rows;
         for (auto messageId : updateDeleteMessages->message_ids_) {
             auto index = getMessageIndex(messageId);
-            if (-1 != index) {
-                beginRemoveRows(QModelIndex(), index, index);
-                delete _messages.take(messageId);
-                _message_ids.remove(index);
-                endRemoveRows();
-            }
+            if (-1 != index) rows.append(index);
         }
+        removeMessageIndexes(rows);
+    }
+}
+
+void Chat::messagesExpired(qint64 chatId, QVector<qint64> messageIds)
+{
+    if (chatId != this->getId()) return;
+
+    QVector<int> rows;
+    for (auto messageId : messageIds) {
+        auto index = getMessageIndex(messageId);
+        if (-1 != index) rows.append(index);
     }
+    removeMessageIndexes(rows);
+}
+
+void Chat::updateMessageSendSucceeded(td_api::updateMessageSendSucceeded *updateMessageSendSucceeded)
+{
+    if (updateMessageSendSucceeded->message_ == nullptr || updateMessageSendSucceeded->message_->chat_id_ != this->getId()) return;
+
+    auto message = _messages.value(updateMessageSendSucceeded->old_message_id_, nullptr);
+    if (message != nullptr) message->updateMessageSendSucceeded(updateMessageSendSucceeded);
 }
+
+void Chat::updateMessageContent(td_api::updateMessageContent *updateMessageContent)
+{
+    if (updateMessageContent->chat_id_ != this->getId()) return;
+
+    auto message = _messages.value(updateMessageContent->message_id_, nullptr);
+    if (message != nullptr) message->updateMessageContent(updateMessageContent);
+}
+
 void Chat::onMessageContentChanged(qint64 messageId)
 {
     auto index = getMessageIndex(messageId);
 
     if (-1 != index) {
         emit dataChanged(createIndex(index, 0), createIndex(index, 0), {FileRole, MessageRole, HasWebPageRole, WebPageRole, PollRole});
+        measureMessages({_messages[messageId]});
     }
 }
 
 void Chat::onMessageIdChanged(qint64 oldMessageId, qint64 newMessageId)
 {
-    qDebug() << oldMessageId << " " << newMessageId;
     auto index = getMessageIndex(oldMessageId);
-    _message_ids[index] = newMessageId;
+    if (index == -1) return;
+
+    int newIndex = std::lower_bound(_message_ids.begin(), _message_ids.end(), newMessageId, std::greater<qint64>()) - _message_ids.begin();
+    if (newIndex > index) --newIndex;
+
     _messages[newMessageId] = _messages.take(oldMessageId);
-    emit dataChanged(createIndex(index, 0), createIndex(index, 0), {IdRole});
+    _messageKeys.remove(oldMessageId);
+    if (_textHeights.contains(oldMessageId)) _textHeights[newMessageId] = _textHeights.take(oldMessageId);
+    if (newIndex != index) {
+        beginMoveRows(QModelIndex(), index, index, QModelIndex(), newIndex > index ? newIndex + 1 : newIndex);
+        _message_ids.remove(index);
+        _message_ids.insert(newIndex, newMessageId);
+        updateMessageKeys(std::min(index, newIndex), std::max(index, newIndex) + 1);
+        endMoveRows();
+    } else {
+        _message_ids[index] = newMessageId;
+        updateMessageKeys(index, index + 1);
+    }
+    emit dataChanged(createIndex(newIndex, 0), createIndex(newIndex, 0), {IdRole});
 }
 
 void Chat::updateBasicGroupFullInfo(td_api::updateBasicGroupFullInfo *updateBasicGroupFullInfo)
 {
-    if (_chat->type_->get_id() == td_api::chatTypeBasicGroup::ID) {
-        auto basicGroupId = static_cast<td_api::chatTypeBasicGroup*>(_chat->type_.get())->basic_group_id_;
+    if (_summary->typeId == td_api::chatTypeBasicGroup::ID) {
+        auto basicGroupId = _summary->getIdFromType();
 
         if (updateBasicGroupFullInfo->basic_group_id_ == basicGroupId) {
             _basicGroupFullInfo->setBasicGroupFullInfo(std::move(updateBasicGroupFullInfo->basic_group_full_info_));
@@ -1040,8 +1615,8 @@ void Chat::updateBasicGroupFullInfo(td_api::updateBasicGroupFullInfo *updateBasi
 
 void Chat::updateSupergroupFullInfo(td_api::updateSupergroupFullInfo *updateSupergroupFullInfo)
 {
-    if (_chat->type_->get_id() == td_api::chatTypeSupergroup::ID) {
-        auto supergroupId = static_cast<td_api::chatTypeSupergroup*>(_chat->type_.get())->supergroup_id_;
+    if (_summary->typeId == td_api::chatTypeSupergroup::ID) {
+        auto supergroupId = _summary->getIdFromType();
 
         if (updateSupergroupFullInfo->supergroup_id_ == supergroupId) {
             _supergroupFullInfo->setSupergroupFullInfo(std::move(updateSupergroupFullInfo->supergroup_full_info_));
@@ -1052,19 +1627,15 @@ void Chat::updateSupergroupFullInfo(td_api::updateSupergroupFullInfo *updateSupe
 
 void Chat::updateSecretChat(td_api::updateSecretChat *updateSecretChat)
 {
-    if (_chat->type_->get_id() == td_api::chatTypeSecret::ID && updateSecretChat->secret_chat_ != nullptr && updateSecretChat->secret_chat_->id_ == getSecretChatId()) {
-        _secretChat = updateSecretChat->secret_chat_.release();
-        emit secretChatChanged(getId());
-        emit ttlChanged(_secretChat->ttl_);
-    }
+    Q_UNUSED(updateSecretChat)
+    emit secretChatChanged(getId());
+    emit ttlChanged(getTtl());
 }
 
 void Chat::updateChatNotificationSettings(td_api::updateChatNotificationSettings *updateChatNotificationSettings)
 {
-    if (updateChatNotificationSettings->chat_id_ == getId()) {
-        _notificationSettings = std::move(updateChatNotificationSettings->notification_settings_);
-        emit chatNotificationSettingsChanged();
-    }
+    Q_UNUSED(updateChatNotificationSettings)
+    emit chatNotificationSettingsChanged();
 }
 
 void Chat::scopeNotificationSettingsChanged(td_api::scopeNotificationSettings *scopeNotificationSettings)
@@ -1074,14 +1645,6 @@ void Chat::scopeNotificationSettingsChanged(td_api::scopeNotificationSettings *s
 
 void Chat::updateChatPinnedMessage(td_api::updateChatPinnedMessage *updateChatPinnedMessage)
 {
-    if (updateChatPinnedMessage->chat_id_ == getId()) {
-        _chat->pinned_message_id_ = updateChatPinnedMessage->pinned_message_id_;
-    }
-}
-
-void Chat::gotMessage(td_api::message *message)
-{
-    if (message->chat_id_ == getId()) {
-        newMessage(td_api::object_ptr<td_api::message>(message));
-    }
+    if (_isActivated && updateChatPinnedMessage->pinned_message_id_ != 0) resolveReplyTargets({updateChatPinnedMessage->pinned_message_id_});
+    emit pinnedMessageIdChanged();
 }
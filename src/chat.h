@@ -22,17 +22,38 @@ along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
 #define CHAT_H
 
 #include <QAbstractListModel>
+#include <QTimer>
+#include <QCache>
 #include "core/telegrammanager.h"
 #include "files/files.h"
 #include "files/file.h"
 #include "users.h"
 #include "message.h"
+#include "chatsummary.h"
+#include "expirywheel.h"
+#include "textlayoutservice.h"
 #include <memory>
 #include <QUrl>
 #include "components/userfullinfo.h"
 #include "components/basicgroupfullinfo.h"
 #include "components/supergroupfullinfo.h"
 
+struct HistoryRequest
+{
+    qint64 fromMessageId;
+    qint32 offset;
+    qint32 limit;
+    bool onlyLocal;
+};
+
+struct OutgoingMessage
+{
+    qint64 localMessageId;
+    QString text;
+    qint64 replyToMessageId;
+    quint64 queryId;
+};
+
 class Chat : public QAbstractListModel
 {
     Q_OBJECT
@@ -59,6 +80,8 @@ class Chat : public QAbstractListModel
     Q_PROPERTY(bool disableMentionNotifications READ getDisableMentionNotifications WRITE setDisableMentionNotifications NOTIFY chatNotificationSettingsChanged)
     Q_PROPERTY(bool defaultDisableMentionNotifications READ getDefaultDisableMentionNotifications NOTIFY chatNotificationSettingsChanged)
     Q_PROPERTY(qint64 pinnedMessageId READ getPinnedMessageId NOTIFY pinnedMessageIdChanged)
+    Q_PROPERTY(qint32 unreadCount READ getUnreadCount NOTIFY unreadCountChanged)
+    Q_PROPERTY(qreal textLayoutWidth READ getTextLayoutWidth NOTIFY textLayoutChanged)
 public:
     enum MessageRoles {
         TypeRole = Qt::UserRole + 1,
@@ -84,7 +107,9 @@ public:
         ReadRole,
         HasWebPageRole,
         WebPageRole,
-        PollRole
+        PollRole,
+        ReplySummaryRole,
+        TextHeightRole
     };
 
     enum ChatList {
@@ -92,7 +117,7 @@ public:
         Archive
     };
 
-    Chat(td_api::chat* chat, shared_ptr<Files> files);
+    Chat(ChatSummary* summary, shared_ptr<Files> files);
     ~Chat();
 
     qint64 getId() const;
@@ -107,16 +132,12 @@ public:
     Q_INVOKABLE QString getChatType() const;
     int getChatList() const;
     qint32 getUnreadCount() const;
-    void setUnreadCount(qint32 unreadCount);
     qint64 lastReadInboxMessageId() const { return _lastReadInboxMessageId; }
     void setLastReadInboxMessageId(qint64 messageId);
     qint64 lastReadOutboxMessageId() const { return _lastReadOutboxMessageId; }
     void setLastReadOutboxMessageId(qint64 messageId);
-    void setChatPhoto(td_api::object_ptr<td_api::chatPhoto> chatPhoto);
     bool isSelf() const;
-    void setIsOpen(bool isOpen);
     bool isOpen() const;
-    void setSecretChat(td_api::secretChat* secretChat);
     QString getSecretChatState() const;
     qint32 getTtl() const;
     qint32 getMuteFor() const;
@@ -133,26 +154,66 @@ public:
     bool getDefaultDisableMentionNotifications() const;
     qint64 getPinnedMessageId();
 
+    void setSummary(ChatSummary* summary);
     void setTelegramManager(shared_ptr<TelegramManager> manager);
     void setUsers(shared_ptr<Users> users);
+    void setExpiryWheel(ExpiryWheel *expiryWheel);
+    void setTextLayoutService(TextLayoutService *textLayoutService);
     void setFiles(shared_ptr<Files> files);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role = TypeRole) const;
     Q_INVOKABLE QHash<int, QByteArray> roleNames() const;
 
-    td_api::chat* getChat();
     Q_INVOKABLE int getMessageIndex(qint64 messageId);
+    int findMessageRow(qint64 messageId) const;
+    Q_INVOKABLE QVariant getMessageData(qint64 messageId, QString roleName);
+    Q_INVOKABLE QVariantMap getReplySummary(qint64 messageId) const;
+    QVariantMap createReplySummary(Message* message) const;
+    QVariantMap createReplySummary(td_api::message* message) const;
+    void resolveReplyTargets(const QVector<qint64> &messageIds);
+    void replyTargetsReceived(const std::vector<std::int64_t> &messageIds, td_api::messages *messages);
     td_api::message* getLastMessage();
     void setLastMessage(td_api::object_ptr<td_api::message> lastMessage);
     void newMessage(td_api::object_ptr<td_api::message> message);
+    Message* createMessage(td_api::object_ptr<td_api::message> message);
+    void recycleMessage(Message* message);
+    void setPoolingEnabled(bool enabled);
+    void insertMessages(QVector<Message*> messages);
+    void removeMessageRows(int first, int count);
+    void removeMessageIndexes(QVector<int> rows);
+    void scheduleExpiry(Message *message);
+    void measureMessages(const QVector<Message*> &messages);
+    void updateMessageKeys(int from, int to);
+    void updateReadRows(qint64 oldMessageId, qint64 newMessageId);
+    void trimMessages(bool keepNewest);
+    void historyReceived(const HistoryRequest &request, int count);
+    void fillHistoryGap(const HistoryRequest &request, qint64 newestMessageId, qint64 oldestMessageId);
+    void addLoadedRange(qint64 from, qint64 to);
+    void clipLoadedRanges();
+    void checkJumpTarget();
+    void loadOutgoingMessages();
+    void saveOutgoingMessages();
+    void showOutgoingMessages();
+    void flushOutgoingMessages();
+    td_api::object_ptr<td_api::message> createLocalMessage(const OutgoingMessage &outgoing) const;
     std::vector<std::int32_t> splitToIntVector(QString string, QString separator);
     std::vector<std::string> splitToVector(QString string, QString separator);
 
     Q_INVOKABLE void sendMessage(QString message, qint64 replyToMessageId);
-    Q_INVOKABLE void getChatHistory(qint64 from_message, int limit = 20, bool localOnly = false);
-    Q_INVOKABLE void getMessage(qint64 messageId);
+    Q_INVOKABLE void getChatHistory(qint64 from_message, int limit = 20, bool localOnly = false, int offset = 0);
     Q_INVOKABLE void getMoreChatHistory();
+    Q_INVOKABLE void getNewerChatHistory();
+    Q_INVOKABLE void loadHistory(int limit);
+    Q_INVOKABLE void setTextLayout(QFont font, qreal width);
+    qreal getTextLayoutWidth() const;
+    void prefetchHistory();
+    void activate();
+    void trimToWarmPage();
+    qint64 getMemoryUsage() const;
+    Q_INVOKABLE void loadMissingMessages(int fromRow, int toRow);
+    Q_INVOKABLE void jumpToMessage(qint64 messageId);
+    Q_INVOKABLE void jumpToFirstUnread();
     Q_INVOKABLE qint64 getAuthorByIndex(qint32 index);
     Q_INVOKABLE void setMessageAsRead(qint64 messageId);
     Q_INVOKABLE void sendPhoto(QString path, qint64 replyToMessageId);
@@ -191,14 +252,24 @@ signals:
     void ttlChanged(qint32 ttl);
     void chatNotificationSettingsChanged();
     void pinnedMessageIdChanged();
+    void messageJumpReady(qint64 messageId);
+    void replySummaryChanged(qint64 messageId);
+    void textLayoutChanged();
 
 public slots:
     void updateChatReadInbox(td_api::updateChatReadInbox *updateChatReadInbox);
     void updateChatReadOutbox(td_api::updateChatReadOutbox *updateChatReadOutbox);
-    void messages(td_api::messages *messages);
+    void messages(quint64 id, td_api::messages *messages);
+    void error(quint64 id, td_api::error *error);
+    void messageSent(quint64 id, td_api::message *message);
     void updateNewMessage(td_api::updateNewMessage *updateNewMessage);
     void updateChatTitle(td_api::updateChatTitle *updateChatTitle);
+    void updateChatPhoto(td_api::updateChatPhoto *updateChatPhoto);
     void updateDeleteMessages(td_api::updateDeleteMessages *updateDeleteMessages);
+    void messagesExpired(qint64 chatId, QVector<qint64> messageIds);
+    void textHeightsMeasured(qint64 chatId, quint32 revision, QVector<qint64> messageIds, QVector<int> heights);
+    void updateMessageSendSucceeded(td_api::updateMessageSendSucceeded *updateMessageSendSucceeded);
+    void updateMessageContent(td_api::updateMessageContent *updateMessageContent);
     void onMessageContentChanged(qint64 messageId);
     void onMessageIdChanged(qint64 oldMessageId, qint64 newMessageId);
     void updateBasicGroupFullInfo(td_api::updateBasicGroupFullInfo *updateBasicGroupFullInfo);
@@ -207,26 +278,62 @@ public slots:
     void updateChatNotificationSettings(td_api::updateChatNotificationSettings *updateChatNotificationSettings);
     void scopeNotificationSettingsChanged(td_api::scopeNotificationSettings *scopeNotificationSettings);
     void updateChatPinnedMessage(td_api::updateChatPinnedMessage *updateChatPinnedMessage);
-    void gotMessage(td_api::message *message);
+    void flushViewedMessages();
+    void onConnectedChanged(bool connected);
 
 private:
-    qint32 _smallPhotoId;
-    qint32 _bigPhotoId;
-    qint32 _unreadCount;
+    static const int MAX_LOADED_MESSAGES;
+    static const int HISTORY_PAGE_SIZE;
+    static const int MAX_HISTORY_PAGE_SIZE;
+    static const int VIEW_MESSAGES_INTERVAL;
+    static const int WARM_PAGE_SIZE;
+    static const int MAX_POOLED_MESSAGES;
+    static const int MAX_POOLED_CONTENTS;
+    static const int REPLY_CACHE_SIZE;
+    static const int REPLY_TEXT_LENGTH;
+    static const qint64 LOCAL_MESSAGE_ID_BASE;
+    static const int FORWARD_BATCH_SIZE;
+
     qint64 _lastReadInboxMessageId;
     qint64 _lastReadOutboxMessageId;
     bool _isAuthorized = false;
-    bool _isOpen = false;
-    td_api::chat *_chat;
+    ChatSummary* _summary;
+    QString _chatType;
     QVector<qint64> _message_ids;
     QMap<qint64, Message*> _messages;
+    QVector<Message*> _messagePool;
+    int _maxPooledMessages;
+    ContentPool _contentPool;
+    QHash<qint64, qint64> _messageKeys;
+    qint64 _firstKey = 0;
+    bool _isActivated = false;
+    bool _isLatestLoaded = true;
+    qint64 _oldestLoadedMessageId = 0;
+    bool _isOldestLoaded = false;
+    qint64 _gapEnd = 0;
+    QMap<qint64, qint64> _loadedRanges;
+    qint64 _jumpMessageId = 0;
+    bool _jumpToNextMessage = false;
+    int _historyPageSize;
+    QHash<quint64, HistoryRequest> _historyRequests;
+    std::vector<qint64> _viewedMessages;
+    QTimer _viewedMessagesTimer;
+    QCache<qint64, QVariantMap> _replySummaries;
+    QSet<qint64> _pendingReplyIds;
+    QHash<quint64, std::vector<std::int64_t>> _replyRequests;
+    QList<OutgoingMessage> _outgoingMessages;
+    qint64 _lastLocalMessageId;
     shared_ptr<TelegramManager> _manager;
     shared_ptr<Users> _users;
     shared_ptr<Files> _files;
+    ExpiryWheel* _expiryWheel = nullptr;
+    TextLayoutService* _textLayoutService = nullptr;
+    QFont _textFont;
+    qreal _textWidth = 0;
+    quint32 _textLayoutRevision = 0;
+    QHash<qint64, int> _textHeights;
     BasicGroupFullInfo* _basicGroupFullInfo;
     SupergroupFullInfo* _supergroupFullInfo;
-    td_api::secretChat* _secretChat;
-    td_api::object_ptr<td_api::chatNotificationSettings> _notificationSettings;
     td_api::scopeNotificationSettings* _scopeNotificationSettings;
 };
 Q_DECLARE_METATYPE(Chat*)
@@ -21,15 +21,39 @@ along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
 #include "chatlist.h"
 #include <QDebug>
 #include <QQmlEngine>
+#include <QDateTime>
+#include <QSettings>
+#include <algorithm>
 #include "overloaded.h"
 
-ChatList::ChatList() : _channelNotificationSettings(nullptr), _groupNotificationSettings(nullptr), _privateNotificationSettings(nullptr)
+const qint64 ChatList::RELEASE_TIMEOUT = 5 * 60 * 1000;
+const int ChatList::MAX_RETAINED_CHATS = 8;
+const qint64 ChatList::MAX_RETAINED_BYTES = 2 * 1024 * 1024;
+const int ChatList::READ_QUEUE_INTERVAL = 250;
+const int ChatList::READ_BATCH_SIZE = 10;
+const int ChatList::PREFETCH_INTERVAL = 200;
+const int ChatList::PREFETCH_CHAT_COUNT = 5;
+const int ChatList::PREFETCH_MESSAGE_BUDGET = 500;
+const int ChatList::MAX_PREFETCH_QUEUE_SIZE = ChatList::MAX_RETAINED_CHATS - 2;
+
+ChatList::ChatList() : _channelNotificationSettings(nullptr), _groupNotificationSettings(nullptr), _privateNotificationSettings(nullptr), _searchModel(this),
+    _mainChatList(this, Chat::ChatList::Main), _archiveChatList(this, Chat::ChatList::Archive)
 {
+    _releaseTimer.setInterval(60 * 1000);
+    connect(&_releaseTimer, SIGNAL(timeout()), this, SLOT(releaseIdleChats()));
+    _releaseTimer.start();
+
+    _readQueueTimer.setInterval(READ_QUEUE_INTERVAL);
+    connect(&_readQueueTimer, SIGNAL(timeout()), this, SLOT(processReadQueue()));
+
+    _prefetchTimer.setInterval(PREFETCH_INTERVAL);
+    connect(&_prefetchTimer, SIGNAL(timeout()), this, SLOT(processPrefetchQueue()));
 }
 
 ChatList::~ChatList()
 {
     for (auto &key: _chats.keys()) {
+        delete _chats[key]->model;
         delete _chats[key];
     }
 }
@@ -41,14 +65,25 @@ void ChatList::setTelegramManager(shared_ptr<TelegramManager> manager)
     _privateNotificationSettings.setTelegramManager(_manager);
     _groupNotificationSettings.setTelegramManager(_manager);
     _channelNotificationSettings.setTelegramManager(_manager);
+    _mainChatList.setTelegramManager(_manager);
+    _archiveChatList.setTelegramManager(_manager);
 
-    connect(_manager.get(), SIGNAL(chats(td_api::chats*)), this, SLOT(newChats(td_api::chats*)));
+    connect(_manager.get(), SIGNAL(chats(quint64,td_api::chats*)), this, SLOT(newChats(quint64,td_api::chats*)));
     connect(_manager.get(), SIGNAL(updateNewChat(td_api::updateNewChat*)), this, SLOT(newChat(td_api::updateNewChat*)));
     connect(_manager.get(), SIGNAL(updateChatPhoto(td_api::updateChatPhoto*)), this, SLOT(updateChatPhoto(td_api::updateChatPhoto*)));
+    connect(_manager.get(), SIGNAL(updateChatTitle(td_api::updateChatTitle*)), this, SLOT(updateChatTitle(td_api::updateChatTitle*)));
+    connect(_manager.get(), SIGNAL(updateChatReadInbox(td_api::updateChatReadInbox*)), this, SLOT(updateChatReadInbox(td_api::updateChatReadInbox*)));
+    connect(_manager.get(), SIGNAL(updateChatReadOutbox(td_api::updateChatReadOutbox*)), this, SLOT(updateChatReadOutbox(td_api::updateChatReadOutbox*)));
+    connect(_manager.get(), SIGNAL(updateChatIsMarkedAsUnread(td_api::updateChatIsMarkedAsUnread*)), this, SLOT(updateChatIsMarkedAsUnread(td_api::updateChatIsMarkedAsUnread*)));
+    connect(_manager.get(), SIGNAL(updateChatNotificationSettings(td_api::updateChatNotificationSettings*)), this, SLOT(updateChatNotificationSettings(td_api::updateChatNotificationSettings*)));
+    connect(_manager.get(), SIGNAL(updateChatPinnedMessage(td_api::updateChatPinnedMessage*)), this, SLOT(updateChatPinnedMessage(td_api::updateChatPinnedMessage*)));
+    connect(_manager.get(), SIGNAL(updateUser(td_api::updateUser*)), this, SLOT(updateUser(td_api::updateUser*)));
     connect(_manager.get(), SIGNAL(updateChatLastMessage(td_api::updateChatLastMessage*)), this, SLOT(updateChatLastMessage(td_api::updateChatLastMessage*)));
     connect(_manager.get(), SIGNAL(updateChatOrder(td_api::updateChatOrder*)), this, SLOT(updateChatOrder(td_api::updateChatOrder*)));
+    connect(_manager.get(), SIGNAL(updateChatChatList(td_api::updateChatChatList*)), this, SLOT(updateChatChatList(td_api::updateChatChatList*)));
     connect(_manager.get(), SIGNAL(updateSecretChat(td_api::updateSecretChat*)), this, SLOT(updateSecretChat(td_api::updateSecretChat*)));
     connect(_manager.get(), SIGNAL(updateScopeNotificationSettings(td_api::updateScopeNotificationSettings*)), this, SLOT(updateScopeNotificationSettings(td_api::updateScopeNotificationSettings*)));
+    connect(_manager.get(), SIGNAL(connectedChanged(bool)), this, SLOT(onConnectedChanged(bool)));
 }
 
 void ChatList::setUsers(shared_ptr<Users> users)
@@ -85,40 +120,35 @@ void ChatList::setForwardedFrom(qint64 forwardedFrom)
     emit forwardedFromChanged();
 }
 
-int ChatList::rowCount(const QModelIndex &parent) const
-{
-    Q_UNUSED(parent)
-    return _chats_ids.length();
-}
-
-QVariant ChatList::data(const QModelIndex &index, int role) const
+QVariant ChatList::getChatData(int64_t chatId, int role) const
 {
-    if (rowCount() <= 0) return QVariant();
+    if (!_chats.contains(chatId)) return QVariant();
 
-    auto chatNode = _chats[_chats_ids[index.row()]];
+    auto chatNode = _chats[chatId];
     switch (role) {
     case ChatElementRoles::TypeRole:
-        return chatNode->getChatType();;
+        return chatNode->getChatType();
     case ChatElementRoles::IdRole:
         return chatNode->getId();
     case ChatElementRoles::NameRole:
         return chatNode->getTitle();
     case ChatElementRoles::OrderRole:
-        return chatNode->getOrder();
+        return static_cast<qint64>(chatNode->order);
     case ChatElementRoles::ChatListRole:
         return chatNode->getChatList();
     case ChatElementRoles::PhotoRole:
-        if (chatNode->hasPhoto()) {
-            return QVariant::fromValue(chatNode->getSmallPhoto());
+        if (chatNode->hasPhoto) {
+            auto file = _files->getFile(chatNode->smallPhotoId);
+            if (file != nullptr) return QVariant::fromValue(file.get());
         }
         return QVariant();
     case ChatElementRoles::HasPhotoRole:
-        return chatNode->hasPhoto();
+        return chatNode->hasPhoto;
     case ChatElementRoles::UnreadCountRole:
-        return chatNode->getUnreadCount();
+        return chatNode->unreadCount;
     case ChatElementRoles::LastMessageRole:
     {
-        td_api::message* message = chatNode->getLastMessage();
+        td_api::message* message = chatNode->lastMessage.get();
         if (message == nullptr) return "";
 
         QString lastMessageInfo = "";
@@ -179,7 +209,7 @@ QVariant ChatList::data(const QModelIndex &index, int role) const
     }
     case ChatElementRoles::LastMessageAuthorRole:
     {
-        td_api::message* message = chatNode->getLastMessage();
+        td_api::message* message = chatNode->lastMessage.get();
         if (message == nullptr) return "";
 
         QString lastMessageInfo = "";
@@ -196,7 +226,7 @@ QVariant ChatList::data(const QModelIndex &index, int role) const
         return lastMessageInfo;
     }
     case ChatElementRoles::IsSelfRole:
-        return chatNode->isSelf();
+        return chatNode->isSelf(_manager->getMyId());
     case ChatElementRoles::SecretChatStateRole:
         return chatNode->getSecretChatState();
     default:
@@ -223,52 +253,26 @@ QHash<int, QByteArray> ChatList::roleNames() const
 }
 
 void ChatList::updateChat(int64_t chat, const QVector<int> &roles) {
-    if(rowCount() <= 0) return;
+    _searchModel.updateChat(chat, roles);
 
-    auto it = std::find(_chats_ids.begin(), _chats_ids.end(), chat);
-    if (it != _chats_ids.end()) {
-        auto index = std::distance(_chats_ids.begin(), it);
-        emit dataChanged(createIndex(index, 0), createIndex(index, 0), roles);
-    }
-}
-
-void ChatList::newChatID(int64_t chat)
-{
-    beginInsertRows(QModelIndex(), rowCount(), rowCount());
-    _chats_ids.push_back(chat);
-    endInsertRows();
+    auto summary = getChatSummary(chat);
+    if (summary != nullptr) getListModel(summary->getChatList())->updateChat(chat, roles);
 }
 
 void ChatList::setChatOrder(int64_t chat, int64_t order)
 {
-    if (false == _chats_ids.contains(chat)) {
-        newChatID(chat);
-    }
+    auto summary = getChatSummary(chat);
+    if (summary == nullptr) return;
 
-    getChat(chat)->setOrder(order);
-    updateChat(chat, {OrderRole});
+    summary->order = order;
+    getListModel(summary->getChatList())->setChatOrder(chat, order);
+    updateUnreadCounters(summary);
+    _searchModel.updateChat(chat, {OrderRole});
 }
 
-void ChatList::getMainChatList(Chat::ChatList chatList)
+bool ChatList::isAuthorized() const
 {
-    qint64 offsetOrder = std::numeric_limits<std::int64_t>::max();
-    qint64 offsetChatId = 0;
-    if (rowCount() > 0) {
-        if (_chats.size() == _chats_ids.length()) return;
-
-        auto chat = _chats[_chats_ids[rowCount()-1]]->getChat();
-        offsetOrder = chat->order_;
-        offsetChatId = chat->id_;
-    }
-
-    td_api::object_ptr<td_api::ChatList> list;
-    if (chatList == Chat::ChatList::Archive) {
-        list = td_api::make_object<td_api::chatListArchive>();
-    } else {
-        list = td_api::make_object<td_api::chatListMain>();
-    }
-
-    _manager->sendQuery(new td_api::getChats(move(list), offsetOrder, offsetChatId, 20));
+    return _isAuthorized;
 }
 
 bool ChatList::getDaemonEnabled() const
@@ -287,46 +291,285 @@ QVariant ChatList::openChat(qint64 chatId)
     if (chat == nullptr) return QVariant();
 
     _manager->sendQuery(new td_api::openChat(chat->getId()));
-    chat->setIsOpen(true);
+    chat->activate();
+    auto summary = _chats[chatId];
+    summary->isOpen = true;
+    _retainedChats.removeOne(chatId);
 
     return QVariant::fromValue(chat);
 }
 
 void ChatList::closeChat(qint64 chatId)
 {
-    auto chat = getChat(chatId);
-    _manager->sendQuery(new td_api::closeChat(chat->getId()));
-    chat->setIsOpen(false);
+    auto summary = getChatSummary(chatId);
+    if (summary == nullptr) return;
+
+    _manager->sendQuery(new td_api::closeChat(chatId));
+    summary->isOpen = false;
+    if (summary->model != nullptr && summary->pageCount == 0) retainChat(summary);
 }
 
-Chat *ChatList::getChat(int64_t chatId) const
+void ChatList::pinChat(qint64 chatId)
 {
-    if (_chats.contains(chatId)) {
-        auto chat = _chats.value(chatId);
-        return chat;
-    } else {
-        qWarning() << "Chat doesn't exist!";
-        return nullptr;
+    auto summary = getChatSummary(chatId);
+    if (summary == nullptr) return;
+
+    summary->pageCount++;
+    _retainedChats.removeOne(chatId);
+}
+
+void ChatList::unpinChat(qint64 chatId)
+{
+    auto summary = getChatSummary(chatId);
+    if (summary == nullptr || summary->pageCount == 0) return;
+
+    summary->pageCount--;
+    if (summary->pageCount == 0 && summary->model != nullptr && !summary->isOpen) {
+        summary->model->trimToWarmPage();
+        retainChat(summary);
     }
 }
 
-QVariant ChatList::getChatAsVariant(qint64 chatId) const
+Chat *ChatList::getChat(int64_t chatId)
 {
-    if (_chats.contains(chatId)) {
-        auto chat = _chats.value(chatId);
+    auto summary = getChatSummary(chatId);
+    if (summary == nullptr) return nullptr;
+
+    if (summary->model == nullptr) {
+        auto chat = new Chat(summary, _files);
+        chat->setTelegramManager(_manager);
+        chat->setUsers(_users);
+        chat->setExpiryWheel(&_expiryWheel);
+        chat->setTextLayoutService(&_textLayoutService);
         QQmlEngine::setObjectOwnership(chat, QQmlEngine::CppOwnership);
-        return QVariant::fromValue(chat);
+
+        auto chatType = summary->getChatType();
+        if (chatType == "channel") {
+            connect(this, SIGNAL(channelNotificationSettingsChanged(td_api::scopeNotificationSettings*)), chat, SLOT(scopeNotificationSettingsChanged(td_api::scopeNotificationSettings*)));
+            chat->scopeNotificationSettingsChanged(_channelNotificationSettings.getScopeNotificationSettings());
+        }
+        if (chatType == "group" || chatType == "supergroup") {
+            connect(this, SIGNAL(groupNotificationSettingsChanged(td_api::scopeNotificationSettings*)), chat, SLOT(scopeNotificationSettingsChanged(td_api::scopeNotificationSettings*)));
+            chat->scopeNotificationSettingsChanged(_groupNotificationSettings.getScopeNotificationSettings());
+        }
+        if (chatType == "private" || chatType == "secret") {
+            connect(this, SIGNAL(privateNotificationSettingsChanged(td_api::scopeNotificationSettings*)), chat, SLOT(scopeNotificationSettingsChanged(td_api::scopeNotificationSettings*)));
+            chat->scopeNotificationSettingsChanged(_privateNotificationSettings.getScopeNotificationSettings());
+        }
+
+        summary->model = chat;
+        if (!summary->isOpen && summary->pageCount == 0) retainChat(summary);
+    }
+
+    return summary->model;
+}
+
+ChatSummary *ChatList::getChatSummary(int64_t chatId) const
+{
+    if (_chats.contains(chatId)) {
+        return _chats.value(chatId);
     } else {
         qWarning() << "Chat doesn't exist!";
-        return QVariant();
+        return nullptr;
     }
 }
 
+QVariant ChatList::getChatAsVariant(qint64 chatId)
+{
+    auto chat = getChat(chatId);
+    if (chat == nullptr) return QVariant();
+
+    return QVariant::fromValue(chat);
+}
+
+QString ChatList::getChatTitle(qint64 chatId) const
+{
+    auto summary = getChatSummary(chatId);
+    if (summary == nullptr) return "";
+
+    return summary->getTitle();
+}
+
 void ChatList::markChatAsRead(qint64 chatId)
 {
+    auto summary = getChatSummary(chatId);
+    if (summary == nullptr) return;
 
-    _manager->sendQuery(new td_api::viewMessages(getChat(chatId)->getId(), {getChat(chatId)->getLastMessage()->id_}, false));
-    _manager->sendQuery(new td_api::toggleChatIsMarkedAsUnread(chatId, false));
+    if (enqueueRead(summary)) {
+        updateChat(chatId, {UnreadCountRole});
+        emit unreadCountersChanged();
+    }
+}
+
+void ChatList::markChatListAsRead(int chatList)
+{
+    bool changed = false;
+    for (auto summary: _chats) {
+        if (summary->getChatList() == chatList && summary->order != 0 && enqueueRead(summary)) changed = true;
+    }
+
+    if (changed) {
+        getListModel(chatList)->updateChats({UnreadCountRole});
+        _searchModel.updateChats({UnreadCountRole});
+        emit unreadCountersChanged();
+    }
+}
+
+bool ChatList::enqueueRead(ChatSummary *summary)
+{
+    if (summary->unreadCount == 0 && !summary->isMarkedAsUnread) return false;
+
+    if (summary->isMarkedAsUnread) {
+        summary->isMarkedAsUnread = false;
+        _queuedUnmarks.insert(summary->getId());
+    }
+    summary->unreadCount = 0;
+    refreshUnreadCounters(summary);
+    if (!_queuedReads.contains(summary->getId())) {
+        _queuedReads.insert(summary->getId());
+        _readQueue.enqueue(summary->getId());
+    }
+    if (!_readQueueTimer.isActive()) {
+        processReadQueue();
+        _readQueueTimer.start();
+    }
+
+    return true;
+}
+
+int ChatList::getCounterType(QString chatType) const
+{
+    if (chatType == "channel") return ChannelCounter;
+    if (chatType == "group" || chatType == "supergroup") return GroupCounter;
+
+    return PrivateCounter;
+}
+
+int ChatList::getCounterIndex(int chatList, int counterType, bool muted) const
+{
+    return (chatList * CounterTypeCount + counterType) * 2 + (muted ? 1 : 0);
+}
+
+bool ChatList::isMuted(ChatSummary *summary)
+{
+    auto settings = summary->notificationSettings.get();
+    if (settings == nullptr) return false;
+    if (!settings->use_default_mute_for_) return settings->mute_for_ > 0;
+
+    td_api::scopeNotificationSettings* scopeSettings;
+    switch (getCounterType(summary->getChatType())) {
+    case ChannelCounter:
+        scopeSettings = _channelNotificationSettings.getScopeNotificationSettings();
+        break;
+    case GroupCounter:
+        scopeSettings = _groupNotificationSettings.getScopeNotificationSettings();
+        break;
+    default:
+        scopeSettings = _privateNotificationSettings.getScopeNotificationSettings();
+        break;
+    }
+
+    return scopeSettings != nullptr && scopeSettings->mute_for_ > 0;
+}
+
+bool ChatList::refreshUnreadCounters(ChatSummary *summary)
+{
+    int counterIndex = -1;
+    qint32 unreadCount = 0;
+    bool unreadChat = false;
+    if (summary->order != 0) {
+        counterIndex = getCounterIndex(summary->getChatList(), getCounterType(summary->getChatType()), isMuted(summary));
+        unreadCount = summary->unreadCount;
+        unreadChat = unreadCount > 0 || summary->isMarkedAsUnread;
+    }
+
+    if (counterIndex == summary->counterIndex && unreadCount == summary->countedUnreadCount && unreadChat == summary->countedUnreadChat) return false;
+
+    if (summary->counterIndex != -1) {
+        _unreadMessageCounters[summary->counterIndex] -= summary->countedUnreadCount;
+        if (summary->countedUnreadChat) _unreadChatCounters[summary->counterIndex]--;
+    }
+    if (counterIndex != -1) {
+        _unreadMessageCounters[counterIndex] += unreadCount;
+        if (unreadChat) _unreadChatCounters[counterIndex]++;
+    }
+
+    summary->counterIndex = counterIndex;
+    summary->countedUnreadCount = unreadCount;
+    summary->countedUnreadChat = unreadChat;
+    return true;
+}
+
+void ChatList::updateUnreadCounters(ChatSummary *summary)
+{
+    if (refreshUnreadCounters(summary)) emit unreadCountersChanged();
+}
+
+qint32 ChatList::getUnreadMessageCount() const
+{
+    qint32 count = 0;
+    for (int counterType = 0; counterType < CounterTypeCount; ++counterType) {
+        count += _unreadMessageCounters[getCounterIndex(Chat::ChatList::Main, counterType, false)];
+    }
+    return count;
+}
+
+qint32 ChatList::getUnreadChatCount() const
+{
+    qint32 count = 0;
+    for (int counterType = 0; counterType < CounterTypeCount; ++counterType) {
+        count += _unreadChatCounters[getCounterIndex(Chat::ChatList::Main, counterType, false)];
+    }
+    return count;
+}
+
+qint32 ChatList::getArchiveUnreadChatCount() const
+{
+    qint32 count = 0;
+    for (int counterType = 0; counterType < CounterTypeCount; ++counterType) {
+        count += _unreadChatCounters[getCounterIndex(Chat::ChatList::Archive, counterType, false)];
+        count += _unreadChatCounters[getCounterIndex(Chat::ChatList::Archive, counterType, true)];
+    }
+    return count;
+}
+
+qint32 ChatList::getUnreadMessageCount(int chatList, QString chatType, bool muted) const
+{
+    return _unreadMessageCounters[getCounterIndex(chatList, getCounterType(chatType), muted)];
+}
+
+qint32 ChatList::getUnreadChatCount(int chatList, QString chatType, bool muted) const
+{
+    return _unreadChatCounters[getCounterIndex(chatList, getCounterType(chatType), muted)];
+}
+
+void ChatList::retainChat(ChatSummary *summary)
+{
+    summary->releaseAfter = QDateTime::currentMSecsSinceEpoch() + RELEASE_TIMEOUT;
+    _retainedChats.removeOne(summary->getId());
+    _retainedChats.append(summary->getId());
+
+    while (_retainedChats.size() > MAX_RETAINED_CHATS) {
+        releaseChat(_chats[_retainedChats.takeFirst()]);
+    }
+
+    qint64 retainedBytes = 0;
+    for (auto chatId: _retainedChats) {
+        if (_chats[chatId]->model != nullptr) retainedBytes += _chats[chatId]->model->getMemoryUsage();
+    }
+    while (retainedBytes > MAX_RETAINED_BYTES && _retainedChats.size() > 1) {
+        auto oldest = _chats[_retainedChats.takeFirst()];
+        if (oldest->model != nullptr) retainedBytes -= oldest->model->getMemoryUsage();
+        releaseChat(oldest);
+    }
+}
+
+void ChatList::releaseChat(ChatSummary *summary)
+{
+    if (summary->model == nullptr || summary->isOpen || summary->pageCount > 0) return;
+
+    summary->model->deleteLater();
+    summary->model = nullptr;
 }
 
 QVariant ChatList::getChannelNotificationSettings()
@@ -350,74 +593,304 @@ QVariant ChatList::getPrivateNotificationSettings()
     return QVariant::fromValue(settings);
 }
 
-void ChatList::onIsAuthorizedChanged(bool isAuthorized)
+QVariant ChatList::getSearchModel()
 {
-    _isAuthorized = isAuthorized;
+    auto* searchModel = &_searchModel;
+    QQmlEngine::setObjectOwnership(searchModel, QQmlEngine::CppOwnership);
+    return QVariant::fromValue(searchModel);
+}
 
-    this->getMainChatList();
+QVariant ChatList::getChatListModel(int chatList)
+{
+    auto* chatListModel = getListModel(chatList);
+    QQmlEngine::setObjectOwnership(chatListModel, QQmlEngine::CppOwnership);
+    return QVariant::fromValue(chatListModel);
 }
 
-void ChatList::onChatPhotoChanged(qint64 chatId)
+ChatListModel *ChatList::getListModel(int chatList)
 {
-    this->updateChat(chatId, {PhotoRole, HasPhotoRole});
+    if (chatList == Chat::ChatList::Archive) return &_archiveChatList;
+
+    return &_mainChatList;
+}
+
+void ChatList::onIsAuthorizedChanged(bool isAuthorized)
+{
+    _isAuthorized = isAuthorized;
+
+    if (_isAuthorized) _mainChatList.fetchMore(QModelIndex());
 }
 
 void ChatList::onUnreadCountChanged(qint64 chatId, qint32 unreadCount)
 {
     Q_UNUSED(unreadCount)
     this->updateChat(chatId, {UnreadCountRole});
+
+    auto summary = getChatSummary(chatId);
+    if (summary != nullptr) updateUnreadCounters(summary);
+}
+
+void ChatList::processReadQueue()
+{
+    for (int i = 0; i < READ_BATCH_SIZE && !_readQueue.isEmpty(); ++i) {
+        auto chatId = _readQueue.dequeue();
+        _queuedReads.remove(chatId);
+        auto unmark = _queuedUnmarks.remove(chatId);
+        auto summary = getChatSummary(chatId);
+        if (summary == nullptr) continue;
+
+        if (summary->lastMessage != nullptr) {
+            _manager->sendQuery(new td_api::viewMessages(summary->getId(), {summary->lastMessage->id_}, true));
+        }
+        if (unmark) {
+            _manager->sendQuery(new td_api::toggleChatIsMarkedAsUnread(summary->getId(), false));
+        }
+    }
+
+    if (_readQueue.isEmpty()) _readQueueTimer.stop();
+}
+
+void ChatList::prefetchChat(qint64 chatId)
+{
+    _prefetchQueue.removeOne(chatId);
+    _prefetchQueue.prepend(chatId);
+    while (_prefetchQueue.size() > MAX_PREFETCH_QUEUE_SIZE) _prefetchQueue.removeLast();
+    if (!_prefetchTimer.isActive()) _prefetchTimer.start();
+}
+
+void ChatList::prefetchTopChats(const std::vector<int64_t> &chatIds)
+{
+    _isTopChatsPrefetched = true;
+
+    QVector<ChatSummary*> summaries;
+    for (auto chatId: chatIds) {
+        auto summary = getChatSummary(chatId);
+        if (summary != nullptr) summaries.append(summary);
+    }
+
+    for (int i = 0; i < PREFETCH_CHAT_COUNT && i < summaries.size() && _prefetchQueue.size() < MAX_PREFETCH_QUEUE_SIZE; ++i) {
+        _prefetchQueue.enqueue(summaries[i]->getId());
+    }
+
+    std::stable_sort(summaries.begin(), summaries.end(), [](ChatSummary* a, ChatSummary* b) { return a->unreadCount > b->unreadCount; });
+    for (int i = 0; i < PREFETCH_CHAT_COUNT && i < summaries.size() && summaries[i]->unreadCount > 0 && _prefetchQueue.size() < MAX_PREFETCH_QUEUE_SIZE; ++i) {
+        if (!_prefetchQueue.contains(summaries[i]->getId())) _prefetchQueue.enqueue(summaries[i]->getId());
+    }
+
+    if (!_prefetchQueue.isEmpty() && !_prefetchTimer.isActive()) _prefetchTimer.start();
+}
+
+int ChatList::getRetainedMessageCount() const
+{
+    int count = 0;
+    for (auto chatId: _retainedChats) {
+        auto summary = _chats.value(chatId, nullptr);
+        if (summary != nullptr && summary->model != nullptr) count += summary->model->rowCount();
+    }
+
+    return count;
+}
+
+void ChatList::processPrefetchQueue()
+{
+    while (!_prefetchQueue.isEmpty()) {
+        auto summary = getChatSummary(_prefetchQueue.dequeue());
+        if (summary == nullptr || summary->isOpen || (summary->model != nullptr && summary->model->rowCount() > 0)) continue;
+
+        if (getRetainedMessageCount() >= PREFETCH_MESSAGE_BUDGET) {
+            _prefetchQueue.clear();
+            break;
+        }
+
+        getChat(summary->getId())->prefetchHistory();
+        break;
+    }
+
+    if (_prefetchQueue.isEmpty()) _prefetchTimer.stop();
+}
+
+void ChatList::onConnectedChanged(bool connected)
+{
+    if (connected) flushOutgoingMessages();
 }
 
-void ChatList::newChats(td_api::chats *chats)
+void ChatList::flushOutgoingMessages()
 {
-    if (chats->chat_ids_.size() != 0) {
-        this->getMainChatList();
+    if (!_manager->isConnected()) return;
+
+    QSettings settings;
+    settings.beginGroup("outgoingMessages");
+    for (auto key: settings.childKeys()) {
+        auto chatId = key.toLongLong();
+        auto chat = getChat(chatId);
+        if (chat != nullptr) {
+            chat->activate();
+        } else if (!_pendingOutgoingChats.contains(chatId)) {
+            _pendingOutgoingChats.insert(chatId);
+            _manager->sendQuery(new td_api::getChat(chatId));
+        }
+    }
+}
+
+void ChatList::releaseIdleChats()
+{
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    while (!_retainedChats.isEmpty() && _chats[_retainedChats.first()]->releaseAfter <= now) {
+        releaseChat(_chats[_retainedChats.takeFirst()]);
+    }
+}
+
+void ChatList::newChats(quint64 id, td_api::chats *chats)
+{
+    if (_mainChatList.chatsReceived(id, chats)) {
+        if (!_isTopChatsPrefetched) {
+            prefetchTopChats(chats->chat_ids_);
+            flushOutgoingMessages();
+        }
+    } else {
+        _archiveChatList.chatsReceived(id, chats);
     }
 }
 
 void ChatList::newChat(td_api::updateNewChat *updateNewChat)
 {
-    auto chat = updateNewChat->chat_.release();
+    auto chat = updateNewChat->chat_.get();
 
     if (chat != nullptr) {
+        ChatSummary* oldSummary = nullptr;
         if (true == _chats.contains(chat->id_)) {
             qWarning() << "Deleting chat";
-            delete _chats[chat->id_];
+            oldSummary = _chats.take(chat->id_);
+            oldSummary->order = 0;
+            updateUnreadCounters(oldSummary);
+            getListModel(oldSummary->getChatList())->removeChat(chat->id_);
+            _retainedChats.removeOne(chat->id_);
         }
 
-        auto newChat = new Chat(chat, _files);
-        newChat->setTelegramManager(_manager);
-        newChat->setUsers(_users);
-        if (newChat->getChatType() == "secret") newChat->setSecretChat(_secretChats[newChat->getSecretChatId()]);
-        QQmlEngine::setObjectOwnership(newChat, QQmlEngine::CppOwnership);
-        connect(newChat, SIGNAL(chatPhotoChanged(qint64)), this, SLOT(onChatPhotoChanged(qint64)));
-        connect(newChat, SIGNAL(unreadCountChanged(qint64,qint32)), this, SLOT(onUnreadCountChanged(qint64,qint32)));
-        connect(newChat, SIGNAL(secretChatChanged(qint64)), this, SLOT(secretChatStateChanged(qint64)));
-
-        if (newChat->getChatType() == "channel") {
-            connect(this, SIGNAL(channelNotificationSettingsChanged(td_api::scopeNotificationSettings*)), newChat, SLOT(scopeNotificationSettingsChanged(td_api::scopeNotificationSettings*)));
-            newChat->scopeNotificationSettingsChanged(_channelNotificationSettings.getScopeNotificationSettings());
+        auto summary = new ChatSummary(chat);
+        setChatPhoto(summary, std::move(chat->photo_));
+        if (summary->getChatType() == "secret") {
+            _secretChatIds[summary->getSecretChatId()] = chat->id_;
+            summary->secretChat = _secretChats.value(summary->getSecretChatId(), nullptr);
         }
-        if (newChat->getChatType() == "group" || newChat->getChatType() == "supergroup") {
-            connect(this, SIGNAL(groupNotificationSettingsChanged(td_api::scopeNotificationSettings*)), newChat, SLOT(scopeNotificationSettingsChanged(td_api::scopeNotificationSettings*)));
-            newChat->scopeNotificationSettingsChanged(_groupNotificationSettings.getScopeNotificationSettings());
+        _chats[chat->id_] = summary;
+
+        if (oldSummary != nullptr) {
+            if (oldSummary->model != nullptr && oldSummary->pageCount > 0) {
+                summary->model = oldSummary->model;
+                summary->isOpen = oldSummary->isOpen;
+                summary->pageCount = oldSummary->pageCount;
+                summary->model->setSummary(summary);
+            } else if (oldSummary->model != nullptr) {
+                oldSummary->model->deleteLater();
+            }
+            delete oldSummary;
         }
-        if (newChat->getChatType() == "private" || newChat->getChatType() == "secret") {
-            connect(this, SIGNAL(privateNotificationSettingsChanged(td_api::scopeNotificationSettings*)), newChat, SLOT(scopeNotificationSettingsChanged(td_api::scopeNotificationSettings*)));
-            newChat->scopeNotificationSettingsChanged(_privateNotificationSettings.getScopeNotificationSettings());
+
+        _searchModel.setChatTitle(chat->id_, summary->getTitle());
+        if (summary->getChatType() == "private" || summary->getChatType() == "secret") {
+            auto userId = summary->getIdFromType();
+            if (!_privateChats.contains(userId, chat->id_)) _privateChats.insert(userId, chat->id_);
+            auto user = _users->getUser(userId);
+            if (user != nullptr) _searchModel.setChatUsername(chat->id_, user->getUserame());
         }
-        _chats[chat->id_] = newChat;
 
-        this->updateChat(chat->id_, {});
+        setChatOrder(chat->id_, chat->order_);
+        if (_pendingOutgoingChats.remove(chat->id_) && _manager->isConnected()) getChat(chat->id_)->activate();
     }
 }
 
+void ChatList::setChatPhoto(ChatSummary *summary, td_api::object_ptr<td_api::chatPhoto> chatPhoto)
+{
+    if (chatPhoto == nullptr) {
+        summary->smallPhotoId = 0;
+        summary->bigPhotoId = 0;
+    } else {
+        summary->smallPhotoId = chatPhoto->small_->id_;
+        _files->appendFile(std::move(chatPhoto->small_), "avatar");
+        summary->bigPhotoId = chatPhoto->big_->id_;
+        _files->appendFile(std::move(chatPhoto->big_), "");
+    }
+    summary->hasPhoto = chatPhoto != nullptr;
+}
+
 void ChatList::updateChatPhoto(td_api::updateChatPhoto *updateChatPhoto)
 {
-    auto chat = updateChatPhoto->chat_id_;
-    auto photo = move(updateChatPhoto->photo_);
-    _chats[chat]->setChatPhoto(move(photo));
-    this->updateChat(chat, {PhotoRole, HasPhotoRole});
+    auto summary = getChatSummary(updateChatPhoto->chat_id_);
+    if (summary == nullptr) return;
+
+    setChatPhoto(summary, move(updateChatPhoto->photo_));
+    if (summary->model != nullptr) summary->model->updateChatPhoto(updateChatPhoto);
+    this->updateChat(updateChatPhoto->chat_id_, {PhotoRole, HasPhotoRole});
+}
+
+void ChatList::updateChatTitle(td_api::updateChatTitle *updateChatTitle)
+{
+    auto summary = getChatSummary(updateChatTitle->chat_id_);
+    if (summary == nullptr) return;
+
+    summary->setTitle(updateChatTitle->title_);
+    if (summary->model != nullptr) summary->model->updateChatTitle(updateChatTitle);
+    _searchModel.setChatTitle(updateChatTitle->chat_id_, summary->getTitle());
+    this->updateChat(updateChatTitle->chat_id_, {NameRole});
+}
+
+void ChatList::updateChatReadInbox(td_api::updateChatReadInbox *updateChatReadInbox)
+{
+    auto summary = getChatSummary(updateChatReadInbox->chat_id_);
+    if (summary == nullptr) return;
+
+    summary->unreadCount = updateChatReadInbox->unread_count_;
+    summary->lastReadInboxMessageId = updateChatReadInbox->last_read_inbox_message_id_;
+    if (summary->model != nullptr) summary->model->updateChatReadInbox(updateChatReadInbox);
+    onUnreadCountChanged(updateChatReadInbox->chat_id_, updateChatReadInbox->unread_count_);
+}
+
+void ChatList::updateChatReadOutbox(td_api::updateChatReadOutbox *updateChatReadOutbox)
+{
+    auto summary = getChatSummary(updateChatReadOutbox->chat_id_);
+    if (summary == nullptr) return;
+
+    summary->lastReadOutboxMessageId = updateChatReadOutbox->last_read_outbox_message_id_;
+    if (summary->model != nullptr) summary->model->updateChatReadOutbox(updateChatReadOutbox);
+}
+
+void ChatList::updateChatIsMarkedAsUnread(td_api::updateChatIsMarkedAsUnread *updateChatIsMarkedAsUnread)
+{
+    auto summary = getChatSummary(updateChatIsMarkedAsUnread->chat_id_);
+    if (summary == nullptr) return;
+
+    summary->isMarkedAsUnread = updateChatIsMarkedAsUnread->is_marked_as_unread_;
+    updateUnreadCounters(summary);
+}
+
+void ChatList::updateChatNotificationSettings(td_api::updateChatNotificationSettings *updateChatNotificationSettings)
+{
+    auto summary = getChatSummary(updateChatNotificationSettings->chat_id_);
+    if (summary == nullptr) return;
+
+    summary->notificationSettings = std::move(updateChatNotificationSettings->notification_settings_);
+    updateUnreadCounters(summary);
+    if (summary->model != nullptr) summary->model->updateChatNotificationSettings(updateChatNotificationSettings);
+}
+
+void ChatList::updateChatPinnedMessage(td_api::updateChatPinnedMessage *updateChatPinnedMessage)
+{
+    auto summary = getChatSummary(updateChatPinnedMessage->chat_id_);
+    if (summary == nullptr) return;
+
+    summary->pinnedMessageId = updateChatPinnedMessage->pinned_message_id_;
+    if (summary->model != nullptr) summary->model->updateChatPinnedMessage(updateChatPinnedMessage);
+}
+
+void ChatList::updateUser(td_api::updateUser *updateUser)
+{
+    if (updateUser->user_ == nullptr) return;
+
+    auto username = QString::fromStdString(updateUser->user_->username_);
+    for (auto chatId: _privateChats.values(updateUser->user_->id_)) {
+        _searchModel.setChatUsername(chatId, username);
+    }
 }
 
 void ChatList::updateChatLastMessage(td_api::updateChatLastMessage *updateChatLastMessage)
@@ -425,7 +898,7 @@ void ChatList::updateChatLastMessage(td_api::updateChatLastMessage *updateChatLa
     setChatOrder(updateChatLastMessage->chat_id_, updateChatLastMessage->order_);
 
     if (updateChatLastMessage->last_message_ != nullptr) {
-        _chats[updateChatLastMessage->chat_id_]->setLastMessage(move(updateChatLastMessage->last_message_));
+        _chats[updateChatLastMessage->chat_id_]->lastMessage = move(updateChatLastMessage->last_message_);
         updateChat(updateChatLastMessage->chat_id_, {LastMessageRole, LastMessageAuthorRole});
     }
 }
@@ -435,16 +908,34 @@ void ChatList::updateChatOrder(td_api::updateChatOrder *updateChatOrder)
     setChatOrder(updateChatOrder->chat_id_, updateChatOrder->order_);
 }
 
-void ChatList::updateSecretChat(td_api::updateSecretChat *updateSecretChat)
+void ChatList::updateChatChatList(td_api::updateChatChatList *updateChatChatList)
 {
-    if (!_secretChats.contains(updateSecretChat->secret_chat_->id_)) {
-        _secretChats[updateSecretChat->secret_chat_->id_] = updateSecretChat->secret_chat_.release();
-    }
+    auto summary = getChatSummary(updateChatChatList->chat_id_);
+    if (summary == nullptr) return;
+
+    getListModel(summary->getChatList())->removeChat(summary->getId());
+    summary->setChatList(updateChatChatList->chat_list_.get());
+    getListModel(summary->getChatList())->setChatOrder(summary->getId(), summary->order);
+    updateChat(summary->getId(), {ChatListRole});
+    updateUnreadCounters(summary);
 }
 
-void ChatList::secretChatStateChanged(qint64 chatId)
+void ChatList::updateSecretChat(td_api::updateSecretChat *updateSecretChat)
 {
-    updateChat(chatId, {SecretChatStateRole});
+    if (updateSecretChat->secret_chat_ == nullptr) return;
+
+    auto secretChatId = updateSecretChat->secret_chat_->id_;
+    delete _secretChats.value(secretChatId, nullptr);
+    auto secretChat = updateSecretChat->secret_chat_.release();
+    _secretChats[secretChatId] = secretChat;
+
+    if (_secretChatIds.contains(secretChatId)) {
+        auto chatId = _secretChatIds[secretChatId];
+        auto summary = _chats[chatId];
+        summary->secretChat = secretChat;
+        if (summary->model != nullptr) summary->model->updateSecretChat(updateSecretChat);
+        updateChat(chatId, {SecretChatStateRole});
+    }
 }
 
 void ChatList::updateScopeNotificationSettings(td_api::updateScopeNotificationSettings *updateScopeNotificationSettings)
@@ -453,14 +944,20 @@ void ChatList::updateScopeNotificationSettings(td_api::updateScopeNotificationSe
     case td_api::notificationSettingsScopeChannelChats::ID:
         _channelNotificationSettings.setScopeNotificationSettings(std::move(updateScopeNotificationSettings->notification_settings_), "channel");
         emit channelNotificationSettingsChanged(_channelNotificationSettings.getScopeNotificationSettings());
-        return;
+        break;
     case td_api::notificationSettingsScopeGroupChats::ID:
         _groupNotificationSettings.setScopeNotificationSettings(std::move(updateScopeNotificationSettings->notification_settings_), "group");
         emit groupNotificationSettingsChanged(_groupNotificationSettings.getScopeNotificationSettings());
-        return;
+        break;
     case td_api::notificationSettingsScopePrivateChats::ID:
         _privateNotificationSettings.setScopeNotificationSettings(std::move(updateScopeNotificationSettings->notification_settings_), "private");
         emit privateNotificationSettingsChanged(_privateNotificationSettings.getScopeNotificationSettings());
-        return;
+        break;
+    }
+
+    bool changed = false;
+    for (auto summary: _chats) {
+        if (refreshUnreadCounters(summary)) changed = true;
     }
+    if (changed) emit unreadCountersChanged();
 }
@@ -21,19 +21,30 @@ along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
 #ifndef CHATLIST_H
 #define CHATLIST_H
 
-#include <QAbstractListModel>
+#include <QObject>
+#include <QTimer>
+#include <QQueue>
+#include <QSet>
 #include "core/telegrammanager.h"
 #include "files/files.h"
 #include "chat.h"
+#include "chatsummary.h"
 #include "users.h"
+#include "chatsearchmodel.h"
+#include "expirywheel.h"
+#include "textlayoutservice.h"
+#include "chatlistmodel.h"
 #include "components/scopenotificationsettings.h"
 
-class ChatList : public QAbstractListModel
+class ChatList : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool daemonEnabled READ getDaemonEnabled WRITE setDaemonEnabled)
     Q_PROPERTY(QStringList selection READ getSelection WRITE setSelection NOTIFY selectionChanged)
     Q_PROPERTY(qint64 forwardedFrom READ getForwardedFrom WRITE setForwardedFrom NOTIFY forwardedFromChanged)
+    Q_PROPERTY(qint32 unreadMessageCount READ getUnreadMessageCount NOTIFY unreadCountersChanged)
+    Q_PROPERTY(qint32 unreadChatCount READ getUnreadChatCount NOTIFY unreadCountersChanged)
+    Q_PROPERTY(qint32 archiveUnreadChatCount READ getArchiveUnreadChatCount NOTIFY unreadCountersChanged)
 public:
     enum ChatElementRoles {
         TypeRole = Qt::UserRole + 1,
@@ -50,6 +61,13 @@ public:
         SecretChatStateRole
     };
 
+    enum CounterType {
+        PrivateCounter,
+        GroupCounter,
+        ChannelCounter,
+        CounterTypeCount
+    };
+
     ChatList();
     ~ChatList();
     void setTelegramManager(shared_ptr<TelegramManager> manager);
@@ -59,25 +77,36 @@ public:
     void setSelection(QStringList selection);
     qint64 getForwardedFrom() const;
     void setForwardedFrom(qint64 forwardedFrom);
+    qint32 getUnreadMessageCount() const;
+    qint32 getUnreadChatCount() const;
+    qint32 getArchiveUnreadChatCount() const;
+    Q_INVOKABLE qint32 getUnreadMessageCount(int chatList, QString chatType, bool muted) const;
+    Q_INVOKABLE qint32 getUnreadChatCount(int chatList, QString chatType, bool muted) const;
 
-    int rowCount(const QModelIndex &parent = QModelIndex()) const;
-    QVariant data(const QModelIndex &index, int role = TypeRole) const;
     QHash<int, QByteArray> roleNames() const;
+    QVariant getChatData(int64_t chatId, int role) const;
 
-    void newChatID(int64_t chat);
     void setChatOrder(int64_t chat, int64_t order);
-    void getMainChatList(Chat::ChatList chatList = Chat::ChatList::Main);
+    bool isAuthorized() const;
     bool getDaemonEnabled() const;
     void setDaemonEnabled(bool daemonEnabled);
 
     Q_INVOKABLE QVariant openChat(qint64 chatId);
     Q_INVOKABLE void closeChat(qint64 chatId);
-    Chat* getChat(int64_t chatId) const;
-    Q_INVOKABLE QVariant getChatAsVariant(qint64 chatId) const;
+    Q_INVOKABLE void pinChat(qint64 chatId);
+    Q_INVOKABLE void unpinChat(qint64 chatId);
+    Chat* getChat(int64_t chatId);
+    ChatSummary* getChatSummary(int64_t chatId) const;
+    Q_INVOKABLE QVariant getChatAsVariant(qint64 chatId);
+    Q_INVOKABLE QString getChatTitle(qint64 chatId) const;
     Q_INVOKABLE void markChatAsRead(qint64 chatId);
+    Q_INVOKABLE void markChatListAsRead(int chatList);
+    Q_INVOKABLE void prefetchChat(qint64 chatId);
     Q_INVOKABLE QVariant getChannelNotificationSettings();
     Q_INVOKABLE QVariant getGroupNotificationSettings();
     Q_INVOKABLE QVariant getPrivateNotificationSettings();
+    Q_INVOKABLE QVariant getSearchModel();
+    Q_INVOKABLE QVariant getChatListModel(int chatList);
 
 signals:
     void channelNotificationSettingsChanged(td_api::scopeNotificationSettings* scopeNotificationSettings);
@@ -85,37 +114,89 @@ signals:
     void privateNotificationSettingsChanged(td_api::scopeNotificationSettings* scopeNotificationSettings);
     void selectionChanged();
     void forwardedFromChanged();
+    void unreadCountersChanged();
 
 public slots:
     void onIsAuthorizedChanged(bool isAuthorized);
-    void onChatPhotoChanged(qint64 chatId);
     void onUnreadCountChanged(qint64 chatId, qint32 unreadCount);
-    void newChats(td_api::chats *_chats);
+    void releaseIdleChats();
+    void processReadQueue();
+    void processPrefetchQueue();
+    void onConnectedChanged(bool connected);
+    void newChats(quint64 id, td_api::chats *chats);
     void newChat(td_api::updateNewChat *updateNewChat);
     void updateChatPhoto(td_api::updateChatPhoto *updateChatPhoto);
+    void updateChatTitle(td_api::updateChatTitle *updateChatTitle);
+    void updateChatReadInbox(td_api::updateChatReadInbox *updateChatReadInbox);
+    void updateChatReadOutbox(td_api::updateChatReadOutbox *updateChatReadOutbox);
+    void updateChatIsMarkedAsUnread(td_api::updateChatIsMarkedAsUnread *updateChatIsMarkedAsUnread);
+    void updateChatNotificationSettings(td_api::updateChatNotificationSettings *updateChatNotificationSettings);
+    void updateChatPinnedMessage(td_api::updateChatPinnedMessage *updateChatPinnedMessage);
+    void updateUser(td_api::updateUser *updateUser);
     void updateChatLastMessage(td_api::updateChatLastMessage *updateChatLastMessage);
     void updateChatOrder(td_api::updateChatOrder *updateChatOrder);
+    void updateChatChatList(td_api::updateChatChatList *updateChatChatList);
     void updateSecretChat(td_api::updateSecretChat *updateSecretChat);
-    void secretChatStateChanged(qint64 chatId);
     void updateScopeNotificationSettings(td_api::updateScopeNotificationSettings *updateScopeNotificationSettings);
 
 protected:
     void updateChat(int64_t chat, const QVector<int> &roles = {IdRole, NameRole});
+    void setChatPhoto(ChatSummary* summary, td_api::object_ptr<td_api::chatPhoto> chatPhoto);
+    void retainChat(ChatSummary* summary);
+    void releaseChat(ChatSummary* summary);
+    ChatListModel* getListModel(int chatList);
+    bool enqueueRead(ChatSummary* summary);
+    void prefetchTopChats(const std::vector<int64_t> &chatIds);
+    int getRetainedMessageCount() const;
+    int getCounterType(QString chatType) const;
+    int getCounterIndex(int chatList, int counterType, bool muted) const;
+    bool isMuted(ChatSummary* summary);
+    bool refreshUnreadCounters(ChatSummary* summary);
+    void updateUnreadCounters(ChatSummary* summary);
+    void flushOutgoingMessages();
 
 private:
-    int64_t openedChat = -1;
+    static const qint64 RELEASE_TIMEOUT;
+    static const int MAX_RETAINED_CHATS;
+    static const qint64 MAX_RETAINED_BYTES;
+    static const int READ_QUEUE_INTERVAL;
+    static const int READ_BATCH_SIZE;
+    static const int PREFETCH_INTERVAL;
+    static const int PREFETCH_CHAT_COUNT;
+    static const int PREFETCH_MESSAGE_BUDGET;
+    static const int MAX_PREFETCH_QUEUE_SIZE;
+
+
     bool _isAuthorized = false;
-    QHash<int64_t, Chat*> _chats;
+    QHash<int64_t, ChatSummary*> _chats;
     QHash<qint32, td_api::secretChat*> _secretChats;
-    QVector<int64_t> _chats_ids;
+    QHash<qint32, int64_t> _secretChatIds;
+    QList<int64_t> _retainedChats;
+    QTimer _releaseTimer;
+    QQueue<int64_t> _readQueue;
+    QSet<int64_t> _queuedReads;
+    QSet<int64_t> _queuedUnmarks;
+    QTimer _readQueueTimer;
+    QQueue<int64_t> _prefetchQueue;
+    QTimer _prefetchTimer;
+    bool _isTopChatsPrefetched = false;
+    QSet<int64_t> _pendingOutgoingChats;
+    QMultiHash<qint32, int64_t> _privateChats;
     std::shared_ptr<TelegramManager> _manager;
     std::shared_ptr<Users> _users;
     std::shared_ptr<Files> _files;
     ScopeNotificationSettings _channelNotificationSettings;
     ScopeNotificationSettings _groupNotificationSettings;
     ScopeNotificationSettings _privateNotificationSettings;
+    ChatSearchModel _searchModel;
+    ExpiryWheel _expiryWheel;
+    TextLayoutService _textLayoutService;
+    ChatListModel _mainChatList;
+    ChatListModel _archiveChatList;
     QStringList _selection;
     qint64 _forwardedFrom;
+    qint32 _unreadMessageCounters[2 * CounterTypeCount * 2] = {};
+    qint32 _unreadChatCounters[2 * CounterTypeCount * 2] = {};
 };
 
 #endif // CHATLIST_H
@@ -0,0 +1,185 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "chatlistmodel.h"
+#include "chatlist.h"
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+const int ChatListModel::FETCH_RETRY_INTERVAL = 5 * 1000;
+
+ChatListModel::ChatListModel(ChatList* chatList, Chat::ChatList list) : QAbstractListModel(), _chatList(chatList), _list(list),
+    _offsetOrder(std::numeric_limits<std::int64_t>::max()), _offsetChatId(0), _requestId(0), _isComplete(false)
+{
+    _retryTimer.setInterval(FETCH_RETRY_INTERVAL);
+    _retryTimer.setSingleShot(true);
+    connect(&_retryTimer, SIGNAL(timeout()), this, SLOT(retryFetch()));
+}
+
+void ChatListModel::setTelegramManager(shared_ptr<TelegramManager> manager)
+{
+    _manager = manager;
+    connect(_manager.get(), SIGNAL(error(quint64, td_api::error*)), this, SLOT(error(quint64, td_api::error*)));
+}
+
+int ChatListModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return _chats.size();
+}
+
+QVariant ChatListModel::data(const QModelIndex &index, int role) const
+{
+    if (index.row() < 0 || index.row() >= rowCount()) return QVariant();
+
+    return _chatList->getChatData(_chats[index.row()].second, role);
+}
+
+QHash<int, QByteArray> ChatListModel::roleNames() const
+{
+    return _chatList->roleNames();
+}
+
+bool ChatListModel::canFetchMore(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return _chatList->isAuthorized() && _requestId == 0 && !_isComplete;
+}
+
+void ChatListModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) return;
+
+    td_api::object_ptr<td_api::ChatList> list;
+    if (_list == Chat::ChatList::Archive) {
+        list = td_api::make_object<td_api::chatListArchive>();
+    } else {
+        list = td_api::make_object<td_api::chatListMain>();
+    }
+
+    _requestId = _manager->sendQuery(new td_api::getChats(move(list), _offsetOrder, _offsetChatId, 20));
+}
+
+bool ChatListModel::contains(int64_t chatId) const
+{
+    return _orders.contains(chatId);
+}
+
+void ChatListModel::setChatOrder(int64_t chatId, int64_t order)
+{
+    if (order == 0) {
+        removeChat(chatId);
+        return;
+    }
+
+    ChatKey key(order, chatId);
+    if (!_orders.contains(chatId)) {
+        auto row = findRow(key);
+        beginInsertRows(QModelIndex(), row, row);
+        _chats.insert(row, key);
+        _orders[chatId] = order;
+        endInsertRows();
+        return;
+    }
+
+    auto from = findRow(ChatKey(_orders[chatId], chatId));
+    auto to = findRow(key);
+    if (to > from) --to;
+    _orders[chatId] = order;
+
+    if (from != to) {
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to);
+        _chats.remove(from);
+        _chats.insert(to, key);
+        endMoveRows();
+    } else {
+        _chats[to] = key;
+    }
+
+    emit dataChanged(createIndex(to, 0), createIndex(to, 0), {ChatList::OrderRole});
+}
+
+void ChatListModel::removeChat(int64_t chatId)
+{
+    if (!_orders.contains(chatId)) return;
+
+    auto row = findRow(ChatKey(_orders.take(chatId), chatId));
+    beginRemoveRows(QModelIndex(), row, row);
+    _chats.remove(row);
+    endRemoveRows();
+}
+
+void ChatListModel::updateChat(int64_t chatId, const QVector<int> &roles)
+{
+    if (!_orders.contains(chatId)) return;
+
+    auto row = findRow(ChatKey(_orders[chatId], chatId));
+    emit dataChanged(createIndex(row, 0), createIndex(row, 0), roles);
+}
+
+void ChatListModel::updateChats(const QVector<int> &roles)
+{
+    if (_chats.isEmpty()) return;
+
+    emit dataChanged(createIndex(0, 0), createIndex(_chats.size() - 1, 0), roles);
+}
+
+bool ChatListModel::chatsReceived(quint64 requestId, td_api::chats *chats)
+{
+    if (requestId != _requestId) return false;
+
+    _requestId = 0;
+    if (chats->chat_ids_.empty()) {
+        _isComplete = true;
+        return true;
+    }
+
+    auto lastChatId = chats->chat_ids_.back();
+    auto summary = _chatList->getChatSummary(lastChatId);
+    if (summary != nullptr) {
+        _offsetOrder = summary->order;
+        _offsetChatId = lastChatId;
+    } else {
+        _isComplete = true;
+    }
+
+    return true;
+}
+
+void ChatListModel::error(quint64 id, td_api::error *error)
+{
+    if (id == 0 || id != _requestId) return;
+
+    qWarning() << "Loading chats failed:" << QString::fromStdString(error->message_);
+    _requestId = 0;
+    _retryTimer.start();
+}
+
+void ChatListModel::retryFetch()
+{
+    fetchMore(QModelIndex());
+}
+
+int ChatListModel::findRow(const ChatKey &key) const
+{
+    return std::lower_bound(_chats.begin(), _chats.end(), key, std::greater<ChatKey>()) - _chats.begin();
+}
@@ -0,0 +1,78 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CHATLISTMODEL_H
+#define CHATLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+#include "core/telegrammanager.h"
+#include "chat.h"
+
+class ChatList;
+
+class ChatListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit ChatListModel(ChatList* chatList, Chat::ChatList list);
+
+    void setTelegramManager(shared_ptr<TelegramManager> manager);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::UserRole + 1) const;
+    QHash<int, QByteArray> roleNames() const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+    bool contains(int64_t chatId) const;
+    void setChatOrder(int64_t chatId, int64_t order);
+    void removeChat(int64_t chatId);
+    void updateChat(int64_t chatId, const QVector<int> &roles);
+    void updateChats(const QVector<int> &roles);
+    bool chatsReceived(quint64 requestId, td_api::chats *chats);
+
+private slots:
+    void error(quint64 id, td_api::error *error);
+    void retryFetch();
+
+private:
+    static const int FETCH_RETRY_INTERVAL;
+
+    typedef std::pair<int64_t, int64_t> ChatKey;
+
+    int findRow(const ChatKey &key) const;
+
+    ChatList* _chatList;
+    Chat::ChatList _list;
+    shared_ptr<TelegramManager> _manager;
+    QVector<ChatKey> _chats;
+    QHash<int64_t, int64_t> _orders;
+    int64_t _offsetOrder;
+    int64_t _offsetChatId;
+    quint64 _requestId;
+    bool _isComplete;
+    QTimer _retryTimer;
+};
+Q_DECLARE_METATYPE(ChatListModel*)
+
+#endif // CHATLISTMODEL_H
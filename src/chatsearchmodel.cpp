@@ -0,0 +1,300 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "chatsearchmodel.h"
+#include "chatlist.h"
+#include <algorithm>
+
+ChatSearchModel::ChatSearchModel(ChatList* chatList) : QAbstractListModel(), _chatList(chatList), _chatListId(0)
+{
+}
+
+int ChatSearchModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return _results.size();
+}
+
+QVariant ChatSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (index.row() < 0 || index.row() >= rowCount()) return QVariant();
+
+    return _chatList->getChatData(_results[index.row()], role);
+}
+
+QHash<int, QByteArray> ChatSearchModel::roleNames() const
+{
+    return _chatList->roleNames();
+}
+
+QString ChatSearchModel::getQuery() const
+{
+    return _query;
+}
+
+void ChatSearchModel::setQuery(QString query)
+{
+    if (_query == query) return;
+
+    _query = query;
+    search();
+
+    emit queryChanged();
+}
+
+int ChatSearchModel::getChatList() const
+{
+    return _chatListId;
+}
+
+void ChatSearchModel::setChatList(int chatList)
+{
+    if (_chatListId == chatList) return;
+
+    _chatListId = chatList;
+    if (!_query.isEmpty()) search();
+
+    emit chatListChanged();
+}
+
+void ChatSearchModel::setChatTitle(int64_t chatId, QString title)
+{
+    if (_chatTitles.contains(chatId)) {
+        auto oldTitle = _chatTitles.take(chatId);
+        _titles.remove(oldTitle, chatId);
+        for (auto word: splitWords(oldTitle)) {
+            _words.remove(word, chatId);
+        }
+    }
+
+    auto normalizedTitle = normalize(title);
+    if (!normalizedTitle.isEmpty()) {
+        _chatTitles[chatId] = normalizedTitle;
+        _titles.insert(normalizedTitle, chatId);
+        for (auto word: splitWords(normalizedTitle)) {
+            _words.insert(word, chatId);
+        }
+    }
+
+    if (!_query.isEmpty()) refreshChat(chatId);
+}
+
+void ChatSearchModel::setChatUsername(int64_t chatId, QString username)
+{
+    if (_chatUsernames.contains(chatId)) {
+        _usernames.remove(_chatUsernames.take(chatId), chatId);
+    }
+
+    auto normalizedUsername = normalize(username);
+    if (!normalizedUsername.isEmpty()) {
+        _chatUsernames[chatId] = normalizedUsername;
+        _usernames.insert(normalizedUsername, chatId);
+    }
+
+    if (!_query.isEmpty()) refreshChat(chatId);
+}
+
+void ChatSearchModel::removeChat(int64_t chatId)
+{
+    setChatTitle(chatId, "");
+    setChatUsername(chatId, "");
+}
+
+void ChatSearchModel::updateChat(int64_t chatId, const QVector<int> &roles)
+{
+    if ((roles.contains(ChatList::OrderRole) || roles.contains(ChatList::ChatListRole)) && !_query.isEmpty()) {
+        refreshChat(chatId);
+        return;
+    }
+
+    auto index = _results.indexOf(chatId);
+    if (index != -1) {
+        emit dataChanged(createIndex(index, 0), createIndex(index, 0), roles);
+    }
+}
+
+void ChatSearchModel::updateChats(const QVector<int> &roles)
+{
+    if (_results.isEmpty()) return;
+
+    emit dataChanged(createIndex(0, 0), createIndex(_results.size() - 1, 0), roles);
+}
+
+QString ChatSearchModel::normalize(const QString &text)
+{
+    return text.simplified().toCaseFolded();
+}
+
+QStringList ChatSearchModel::splitWords(const QString &text)
+{
+    QStringList words;
+    int start = -1;
+
+    for (int i = 0; i <= text.length(); ++i) {
+        bool isWordCharacter = i < text.length() && text[i].isLetterOrNumber();
+        if (isWordCharacter && start == -1) {
+            start = i;
+        } else if (!isWordCharacter && start != -1) {
+            words << text.mid(start, i - start);
+            start = -1;
+        }
+    }
+
+    return words;
+}
+
+void ChatSearchModel::collect(const QMultiMap<QString, int64_t> &index, const QString &prefix, int rank, QHash<int64_t, int> &ranks)
+{
+    for (auto it = index.lowerBound(prefix); it != index.end() && it.key().startsWith(prefix); ++it) {
+        if (!ranks.contains(it.value()) || ranks[it.value()] > rank) {
+            ranks[it.value()] = rank;
+        }
+    }
+}
+
+int ChatSearchModel::matchRank(int64_t chatId) const
+{
+    if (_chatList->getChatData(chatId, ChatList::ChatListRole).toInt() != _chatListId) return -1;
+
+    auto query = normalize(_query);
+    if (query.isEmpty()) return -1;
+
+    auto title = _chatTitles.value(chatId);
+    if (title.startsWith(query)) return TitleMatch;
+
+    auto username = query.startsWith('@') ? query.mid(1) : query;
+    if (!username.isEmpty() && _chatUsernames.value(chatId).startsWith(username)) return UsernameMatch;
+
+    auto words = splitWords(query);
+    if (words.isEmpty()) return -1;
+
+    auto titleWords = splitWords(title);
+    for (auto &word: words) {
+        bool found = false;
+        for (auto &titleWord: titleWords) {
+            if (titleWord.startsWith(word)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) return -1;
+    }
+
+    return WordMatch;
+}
+
+std::tuple<int, qint64, int64_t> ChatSearchModel::sortKey(int64_t chatId, int rank) const
+{
+    return std::make_tuple(rank, -_chatList->getChatData(chatId, ChatList::OrderRole).toLongLong(), chatId);
+}
+
+void ChatSearchModel::refreshChat(int64_t chatId)
+{
+    auto row = _results.indexOf(chatId);
+    auto rank = matchRank(chatId);
+
+    if (rank == -1) {
+        if (row == -1) return;
+
+        beginRemoveRows(QModelIndex(), row, row);
+        _results.remove(row);
+        _ranks.remove(chatId);
+        endRemoveRows();
+        return;
+    }
+
+    auto results = _results;
+    if (row != -1) results.remove(row);
+
+    auto key = sortKey(chatId, rank);
+    auto position = std::lower_bound(results.begin(), results.end(), key, [this](int64_t id, const std::tuple<int, qint64, int64_t> &value) {
+        return sortKey(id, _ranks.value(id)) < value;
+    });
+    int newRow = position - results.begin();
+
+    if (row == -1) {
+        beginInsertRows(QModelIndex(), newRow, newRow);
+        _results.insert(newRow, chatId);
+        _ranks[chatId] = rank;
+        endInsertRows();
+    } else if (row == newRow) {
+        _ranks[chatId] = rank;
+        emit dataChanged(createIndex(row, 0), createIndex(row, 0));
+    } else {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), newRow > row ? newRow + 1 : newRow);
+        results.insert(newRow, chatId);
+        _results = results;
+        _ranks[chatId] = rank;
+        endMoveRows();
+    }
+}
+
+void ChatSearchModel::search()
+{
+    beginResetModel();
+    _results.clear();
+    _ranks.clear();
+
+    auto query = normalize(_query);
+    if (!query.isEmpty()) {
+        QHash<int64_t, int> ranks;
+        collect(_titles, query, TitleMatch, ranks);
+
+        auto username = query.startsWith('@') ? query.mid(1) : query;
+        if (!username.isEmpty()) collect(_usernames, username, UsernameMatch, ranks);
+
+        auto words = splitWords(query);
+        if (!words.isEmpty()) {
+            QHash<int64_t, int> wordMatches;
+            collect(_words, words.first(), WordMatch, wordMatches);
+
+            for (int i = 1; i < words.size() && !wordMatches.isEmpty(); ++i) {
+                QHash<int64_t, int> nextWordMatches;
+                collect(_words, words[i], WordMatch, nextWordMatches);
+
+                for (auto it = wordMatches.begin(); it != wordMatches.end();) {
+                    if (nextWordMatches.contains(it.key())) ++it;
+                    else it = wordMatches.erase(it);
+                }
+            }
+
+            for (auto it = wordMatches.constBegin(); it != wordMatches.constEnd(); ++it) {
+                if (!ranks.contains(it.key())) ranks[it.key()] = WordMatch;
+            }
+        }
+
+        QVector<std::tuple<int, qint64, int64_t>> results;
+        results.reserve(ranks.size());
+        for (auto it = ranks.constBegin(); it != ranks.constEnd(); ++it) {
+            if (_chatList->getChatData(it.key(), ChatList::ChatListRole).toInt() != _chatListId) continue;
+
+            _ranks[it.key()] = it.value();
+            results.append(sortKey(it.key(), it.value()));
+        }
+        std::sort(results.begin(), results.end());
+
+        _results.reserve(results.size());
+        for (auto &result: results) {
+            _results.append(std::get<2>(result));
+        }
+    }
+
+    endResetModel();
+}
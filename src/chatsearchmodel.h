@@ -0,0 +1,87 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CHATSEARCHMODEL_H
+#define CHATSEARCHMODEL_H
+
+#include <QAbstractListModel>
+#include <QMultiMap>
+#include <QHash>
+#include <QVector>
+#include <tuple>
+
+class ChatList;
+
+class ChatSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString query READ getQuery WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(int chatList READ getChatList WRITE setChatList NOTIFY chatListChanged)
+public:
+    enum MatchRank {
+        TitleMatch,
+        UsernameMatch,
+        WordMatch
+    };
+
+    explicit ChatSearchModel(ChatList* chatList);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::UserRole + 1) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    QString getQuery() const;
+    void setQuery(QString query);
+    int getChatList() const;
+    void setChatList(int chatList);
+
+    void setChatTitle(int64_t chatId, QString title);
+    void setChatUsername(int64_t chatId, QString username);
+    void removeChat(int64_t chatId);
+    void updateChat(int64_t chatId, const QVector<int> &roles);
+    void updateChats(const QVector<int> &roles);
+
+signals:
+    void queryChanged();
+    void chatListChanged();
+
+private:
+    static QString normalize(const QString &text);
+    static QStringList splitWords(const QString &text);
+    static void collect(const QMultiMap<QString, int64_t> &index, const QString &prefix, int rank, QHash<int64_t, int> &ranks);
+    int matchRank(int64_t chatId) const;
+    std::tuple<int, qint64, int64_t> sortKey(int64_t chatId, int rank) const;
+    void refreshChat(int64_t chatId);
+    void search();
+
+    ChatList* _chatList;
+    QString _query;
+    int _chatListId;
+    QVector<int64_t> _results;
+    QHash<int64_t, int> _ranks;
+    QMultiMap<QString, int64_t> _titles;
+    QMultiMap<QString, int64_t> _words;
+    QMultiMap<QString, int64_t> _usernames;
+    QHash<int64_t, QString> _chatTitles;
+    QHash<int64_t, QString> _chatUsernames;
+};
+Q_DECLARE_METATYPE(ChatSearchModel*)
+
+#endif // CHATSEARCHMODEL_H
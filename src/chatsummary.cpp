@@ -0,0 +1,152 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "chatsummary.h"
+#include "chat.h"
+
+ChatSummary::ChatSummary(td_api::chat *chat) :
+    id(chat->id_),
+    typeId(chat->type_->get_id()),
+    typeTargetId(-1),
+    secretChatId(0),
+    isChannel(false),
+    chatListId(td_api::chatListMain::ID),
+    order(chat->order_),
+    unreadCount(chat->unread_count_),
+    isMarkedAsUnread(chat->is_marked_as_unread_),
+    lastReadInboxMessageId(chat->last_read_inbox_message_id_),
+    lastReadOutboxMessageId(chat->last_read_outbox_message_id_),
+    pinnedMessageId(chat->pinned_message_id_),
+    hasPhoto(chat->photo_ != nullptr),
+    notificationSettings(std::move(chat->notification_settings_)),
+    lastMessage(std::move(chat->last_message_)),
+    secretChat(nullptr),
+    title(QString::fromStdString(chat->title_)),
+    smallPhotoId(0),
+    bigPhotoId(0),
+    isOpen(false),
+    pageCount(0),
+    model(nullptr),
+    releaseAfter(0),
+    counterIndex(-1),
+    countedUnreadCount(0),
+    countedUnreadChat(false)
+{
+    switch (typeId) {
+    case td_api::chatTypeBasicGroup::ID:
+        typeTargetId = static_cast<td_api::chatTypeBasicGroup*>(chat->type_.get())->basic_group_id_;
+        break;
+    case td_api::chatTypePrivate::ID:
+        typeTargetId = static_cast<td_api::chatTypePrivate*>(chat->type_.get())->user_id_;
+        break;
+    case td_api::chatTypeSecret::ID:
+        typeTargetId = static_cast<td_api::chatTypeSecret*>(chat->type_.get())->user_id_;
+        secretChatId = static_cast<td_api::chatTypeSecret*>(chat->type_.get())->secret_chat_id_;
+        break;
+    case td_api::chatTypeSupergroup::ID:
+        typeTargetId = static_cast<td_api::chatTypeSupergroup*>(chat->type_.get())->supergroup_id_;
+        isChannel = static_cast<td_api::chatTypeSupergroup*>(chat->type_.get())->is_channel_;
+        break;
+    }
+
+    setChatList(chat->chat_list_.get());
+}
+
+qint64 ChatSummary::getId() const
+{
+    return id;
+}
+
+QString ChatSummary::getTitle() const
+{
+    return title;
+}
+
+void ChatSummary::setTitle(const std::string &title)
+{
+    this->title = QString::fromStdString(title);
+}
+
+void ChatSummary::setChatList(td_api::ChatList *chatList)
+{
+    if (chatList == nullptr) chatListId = td_api::chatListMain::ID;
+    else chatListId = chatList->get_id();
+}
+
+QString ChatSummary::getChatType() const
+{
+    switch (typeId) {
+    case td_api::chatTypeBasicGroup::ID:
+        return QStringLiteral("group");
+    case td_api::chatTypePrivate::ID:
+        return QStringLiteral("private");
+    case td_api::chatTypeSecret::ID:
+        return QStringLiteral("secret");
+    case td_api::chatTypeSupergroup::ID:
+        if (isChannel) return QStringLiteral("channel");
+        return QStringLiteral("supergroup");
+    default:
+        return QString();
+    }
+}
+
+int ChatSummary::getChatList() const
+{
+    switch (chatListId) {
+    case td_api::chatListArchive::ID:
+        return Chat::ChatList::Archive;
+    case td_api::chatListMain::ID:
+    default:
+        return Chat::ChatList::Main;
+    }
+}
+
+qint32 ChatSummary::getIdFromType() const
+{
+    return typeTargetId;
+}
+
+qint32 ChatSummary::getSecretChatId() const
+{
+    return secretChatId;
+}
+
+QString ChatSummary::getSecretChatState() const
+{
+    if (secretChat == nullptr) return QString();
+
+    switch (secretChat->state_->get_id()) {
+    case td_api::secretChatStateReady::ID:
+        return QStringLiteral("ready");
+    case td_api::secretChatStateClosed::ID:
+        return QStringLiteral("closed");
+    case td_api::secretChatStatePending::ID:
+        return QStringLiteral("pending");
+    default:
+        return QString();
+    }
+}
+
+bool ChatSummary::isSelf(qint32 myId) const
+{
+    if (typeId != td_api::chatTypePrivate::ID) return false;
+
+    return getIdFromType() == myId;
+}
@@ -0,0 +1,72 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CHATSUMMARY_H
+#define CHATSUMMARY_H
+
+#include <QString>
+#include "core/telegrammanager.h"
+
+class Chat;
+
+struct ChatSummary
+{
+    ChatSummary(td_api::chat* chat);
+
+    qint64 getId() const;
+    QString getTitle() const;
+    void setTitle(const std::string &title);
+    void setChatList(td_api::ChatList* chatList);
+    QString getChatType() const;
+    int getChatList() const;
+    qint32 getIdFromType() const;
+    qint32 getSecretChatId() const;
+    QString getSecretChatState() const;
+    bool isSelf(qint32 myId) const;
+
+    qint64 id;
+    qint32 typeId;
+    qint32 typeTargetId;
+    qint32 secretChatId;
+    bool isChannel;
+    qint32 chatListId;
+    int64_t order;
+    qint32 unreadCount;
+    bool isMarkedAsUnread;
+    qint64 lastReadInboxMessageId;
+    qint64 lastReadOutboxMessageId;
+    qint64 pinnedMessageId;
+    bool hasPhoto;
+    td_api::object_ptr<td_api::chatNotificationSettings> notificationSettings;
+    td_api::object_ptr<td_api::message> lastMessage;
+    td_api::secretChat* secretChat;
+    QString title;
+    qint32 smallPhotoId;
+    qint32 bigPhotoId;
+    bool isOpen;
+    int pageCount;
+    Chat* model;
+    qint64 releaseAfter;
+    int counterIndex;
+    qint32 countedUnreadCount;
+    bool countedUnreadChat;
+};
+
+#endif // CHATSUMMARY_H
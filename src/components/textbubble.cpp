@@ -0,0 +1,527 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "textbubble.h"
+#include <QSGGeometryNode>
+#include <QSGFlatColorMaterial>
+#include <QFontMetricsF>
+#include <QtMath>
+#include <QRegularExpression>
+#include <QtQuick/private/qquicktextnode_p.h>
+#include <algorithm>
+
+const int TextBubble::WIDE_TEXT_LENGTH = 30;
+const int TextBubble::CORNER_SEGMENTS = 6;
+
+TextBubble::TextBubble(QQuickItem *parent) : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+QString TextBubble::getText() const
+{
+    return _text;
+}
+
+void TextBubble::setText(QString text)
+{
+    if (_text == text) return;
+
+    _text = text;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+QString TextBubble::getAuthor() const
+{
+    return _author;
+}
+
+void TextBubble::setAuthor(QString author)
+{
+    if (_author == author) return;
+
+    _author = author;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+QString TextBubble::getTime() const
+{
+    return _time;
+}
+
+void TextBubble::setTime(QString time)
+{
+    if (_time == time) return;
+
+    _time = time;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+bool TextBubble::getIsRead() const
+{
+    return _isRead;
+}
+
+void TextBubble::setIsRead(bool isRead)
+{
+    if (_isRead == isRead) return;
+
+    _isRead = isRead;
+    _contentDirty = true;
+    update();
+
+    emit bubbleChanged();
+}
+
+bool TextBubble::getReceived() const
+{
+    return _received;
+}
+
+void TextBubble::setReceived(bool received)
+{
+    if (_received == received) return;
+
+    _received = received;
+    _contentDirty = true;
+    update();
+
+    emit bubbleChanged();
+}
+
+QFont TextBubble::getFont() const
+{
+    return _font;
+}
+
+void TextBubble::setFont(QFont font)
+{
+    if (_font == font) return;
+
+    _font = font;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+QFont TextBubble::getTimeFont() const
+{
+    return _timeFont;
+}
+
+void TextBubble::setTimeFont(QFont timeFont)
+{
+    if (_timeFont == timeFont) return;
+
+    _timeFont = timeFont;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+QColor TextBubble::getColor() const
+{
+    return _color;
+}
+
+void TextBubble::setColor(QColor color)
+{
+    if (_color == color) return;
+
+    _color = color;
+    _contentDirty = true;
+    update();
+
+    emit bubbleChanged();
+}
+
+QColor TextBubble::getAuthorColor() const
+{
+    return _authorColor;
+}
+
+void TextBubble::setAuthorColor(QColor authorColor)
+{
+    if (_authorColor == authorColor) return;
+
+    _authorColor = authorColor;
+    _contentDirty = true;
+    update();
+
+    emit bubbleChanged();
+}
+
+QColor TextBubble::getLinkColor() const
+{
+    return _linkColor;
+}
+
+void TextBubble::setLinkColor(QColor linkColor)
+{
+    if (_linkColor == linkColor) return;
+
+    _linkColor = linkColor;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+QColor TextBubble::getTimeColor() const
+{
+    return _timeColor;
+}
+
+void TextBubble::setTimeColor(QColor timeColor)
+{
+    if (_timeColor == timeColor) return;
+
+    _timeColor = timeColor;
+    _contentDirty = true;
+    update();
+
+    emit bubbleChanged();
+}
+
+QColor TextBubble::getBackgroundColor() const
+{
+    return _backgroundColor;
+}
+
+void TextBubble::setBackgroundColor(QColor backgroundColor)
+{
+    if (_backgroundColor == backgroundColor) return;
+
+    _backgroundColor = backgroundColor;
+    update();
+
+    emit bubbleChanged();
+}
+
+qreal TextBubble::getMaximumWidth() const
+{
+    return _maximumWidth;
+}
+
+void TextBubble::setMaximumWidth(qreal maximumWidth)
+{
+    if (_maximumWidth == maximumWidth) return;
+
+    _maximumWidth = maximumWidth;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+qreal TextBubble::getPadding() const
+{
+    return _padding;
+}
+
+void TextBubble::setPadding(qreal padding)
+{
+    if (_padding == padding) return;
+
+    _padding = padding;
+    _layoutDirty = true;
+    polish();
+
+    emit bubbleChanged();
+}
+
+qreal TextBubble::getRadius() const
+{
+    return _radius;
+}
+
+void TextBubble::setRadius(qreal radius)
+{
+    if (_radius == radius) return;
+
+    _radius = radius;
+    _geometryDirty = true;
+    update();
+
+    emit bubbleChanged();
+}
+
+void TextBubble::findLinks(const QString &text)
+{
+    static const QRegularExpression linkExpression(QStringLiteral("\\b(?:https?://|www\\.)[^\\s<>\"]*[^\\s<>\".,;:!?)\\]']"), QRegularExpression::CaseInsensitiveOption);
+
+    _links.clear();
+    QVector<QTextLayout::FormatRange> formats;
+    auto matches = linkExpression.globalMatch(text);
+    while (matches.hasNext()) {
+        auto match = matches.next();
+        auto url = match.captured();
+        if (!url.contains(QStringLiteral("://"))) url.prepend(QStringLiteral("http://"));
+        _links.append({match.capturedStart(), match.capturedLength(), url});
+
+        QTextLayout::FormatRange format;
+        format.start = match.capturedStart();
+        format.length = match.capturedLength();
+        format.format.setForeground(_linkColor);
+        format.format.setFontUnderline(true);
+        formats.append(format);
+    }
+    _textLayout.setFormats(formats);
+}
+
+QString TextBubble::linkAt(qreal x, qreal y) const
+{
+    if (_links.isEmpty()) return QString();
+
+    QPointF position(x - _padding, y - _padding - _authorHeight);
+    for (int i = 0; i < _textLayout.lineCount(); ++i) {
+        auto line = _textLayout.lineAt(i);
+        if (position.y() < line.y() || position.y() >= line.y() + line.height()) continue;
+        if (position.x() < 0 || position.x() > line.naturalTextWidth()) return QString();
+
+        auto cursor = line.xToCursor(position.x(), QTextLine::CursorOnCharacter);
+        for (auto &link: _links) {
+            if (cursor >= link.start && cursor < link.start + link.length) return link.url;
+        }
+        return QString();
+    }
+
+    return QString();
+}
+
+void TextBubble::updateLayout()
+{
+    auto contentMaximumWidth = std::max<qreal>(0, _maximumWidth - 2 * _padding);
+    auto text = _text.trimmed().replace('\n', QChar::LineSeparator);
+
+    QTextOption option;
+    option.setWrapMode(text.length() > WIDE_TEXT_LENGTH ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
+    _textLayout.clearLayout();
+    _textLayout.setText(text);
+    _textLayout.setFont(_font);
+    _textLayout.setTextOption(option);
+    findLinks(text);
+
+    qreal textWidth = 0;
+    _textHeight = 0;
+    _textLayout.beginLayout();
+    forever {
+        auto line = _textLayout.createLine();
+        if (!line.isValid()) break;
+
+        line.setLineWidth(contentMaximumWidth);
+        line.setPosition(QPointF(0, _textHeight));
+        _textHeight += line.height();
+        textWidth = std::max(textWidth, line.naturalTextWidth());
+    }
+    _textLayout.endLayout();
+
+    QFontMetricsF authorMetrics(_font);
+    _authorLayout.clearLayout();
+    _authorLayout.setText(authorMetrics.elidedText(_author, Qt::ElideRight, contentMaximumWidth));
+    _authorLayout.setFont(_font);
+    _authorLayout.beginLayout();
+    auto authorLine = _authorLayout.createLine();
+    if (authorLine.isValid()) authorLine.setLineWidth(contentMaximumWidth);
+    _authorLayout.endLayout();
+    _authorHeight = _author.isEmpty() ? 0 : authorMetrics.height();
+
+    QFontMetricsF timeMetrics(_timeFont);
+    _timeLayout.clearLayout();
+    _timeLayout.setText(_time);
+    _timeLayout.setFont(_timeFont);
+    _timeLayout.beginLayout();
+    auto timeLine = _timeLayout.createLine();
+    if (timeLine.isValid()) timeLine.setLineWidth(timeMetrics.width(_time));
+    _timeLayout.endLayout();
+    _footerHeight = timeMetrics.height();
+    _footerWidth = timeMetrics.width(_time) + _footerHeight * 1.5;
+
+    auto authorWidth = _authorLayout.lineCount() > 0 ? _authorLayout.lineAt(0).naturalTextWidth() : 0;
+    auto contentWidth = std::max(std::max(textWidth, authorWidth), _footerWidth);
+    setImplicitSize(std::ceil(contentWidth + 2 * _padding), std::ceil(_authorHeight + _textHeight + _footerHeight + 2 * _padding));
+}
+
+void TextBubble::updateContentNode(QSGNode *contentNode)
+{
+    auto textNode = static_cast<QQuickTextNode*>(contentNode->firstChild());
+    auto statusNode = static_cast<QSGGeometryNode*>(textNode->nextSibling());
+    textNode->deleteContent();
+
+    auto y = _padding;
+    if (!_author.isEmpty() && _authorLayout.lineCount() > 0) {
+        auto authorWidth = _authorLayout.lineAt(0).naturalTextWidth();
+        textNode->addTextLayout(QPointF(_received ? _padding : width() - _padding - authorWidth, y), &_authorLayout, _authorColor);
+        y += _authorHeight;
+    }
+
+    textNode->addTextLayout(QPointF(_padding, y), &_textLayout, _color, QQuickText::Normal, QColor(), _linkColor);
+    y += _textHeight;
+
+    auto footerX = _received ? _padding : width() - _padding - _footerWidth;
+    auto timeWidth = _footerWidth - _footerHeight * 1.5;
+    if (_timeLayout.lineCount() > 0) textNode->addTextLayout(QPointF(footerX, y + (_footerHeight - _timeLayout.lineAt(0).height()) / 2), &_timeLayout, _timeColor);
+
+    updateStatusGeometry(statusNode->geometry(), QRectF(footerX + timeWidth + _footerHeight / 2, y, _footerHeight, _footerHeight));
+    statusNode->markDirty(QSGNode::DirtyGeometry);
+
+    auto statusMaterial = static_cast<QSGFlatColorMaterial*>(statusNode->material());
+    if (statusMaterial->color() != _timeColor) {
+        statusMaterial->setColor(_timeColor);
+        statusNode->markDirty(QSGNode::DirtyMaterial);
+    }
+}
+
+void TextBubble::updateStatusGeometry(QSGGeometry *geometry, const QRectF &rect) const
+{
+    geometry->setLineWidth(std::max<qreal>(1, rect.height() / 10));
+
+    auto icon = rect.adjusted(rect.width() / 6, rect.height() / 6, -rect.width() / 6, -rect.height() / 6);
+    if (_isRead) {
+        geometry->allocate(4);
+        auto vertices = geometry->vertexDataAsPoint2D();
+        vertices[0].set(icon.left(), icon.center().y());
+        vertices[1].set(icon.left() + icon.width() / 3, icon.bottom());
+        vertices[2] = vertices[1];
+        vertices[3].set(icon.right(), icon.top());
+        return;
+    }
+
+    auto segments = 4 * CORNER_SEGMENTS;
+    geometry->allocate(2 * segments + 4);
+    auto vertices = geometry->vertexDataAsPoint2D();
+    for (int i = 0; i < segments; ++i) {
+        auto angle = 2 * M_PI * i / segments;
+        auto nextAngle = 2 * M_PI * (i + 1) / segments;
+        vertices[2 * i].set(icon.center().x() + icon.width() / 2 * qCos(angle), icon.center().y() + icon.height() / 2 * qSin(angle));
+        vertices[2 * i + 1].set(icon.center().x() + icon.width() / 2 * qCos(nextAngle), icon.center().y() + icon.height() / 2 * qSin(nextAngle));
+    }
+    vertices[2 * segments].set(icon.center().x(), icon.center().y());
+    vertices[2 * segments + 1].set(icon.center().x(), icon.top() + icon.height() / 4);
+    vertices[2 * segments + 2].set(icon.center().x(), icon.center().y());
+    vertices[2 * segments + 3].set(icon.right() - icon.width() / 4, icon.center().y());
+}
+
+void TextBubble::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size()) {
+        _geometryDirty = true;
+        _contentDirty = true;
+        update();
+    }
+}
+
+void TextBubble::updatePolish()
+{
+    if (!_layoutDirty) return;
+
+    updateLayout();
+    _layoutDirty = false;
+    _contentDirty = true;
+    update();
+}
+
+QSGNode *TextBubble::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    if (width() <= 0 || height() <= 0) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    auto background = static_cast<QSGGeometryNode*>(oldNode);
+    if (background == nullptr) {
+        background = new QSGGeometryNode();
+        auto geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+        geometry->setDrawingMode(GL_TRIANGLE_FAN);
+        background->setGeometry(geometry);
+        background->setFlag(QSGNode::OwnsGeometry);
+        background->setMaterial(new QSGFlatColorMaterial());
+        background->setFlag(QSGNode::OwnsMaterial);
+
+        background->appendChildNode(new QQuickTextNode(this));
+
+        auto status = new QSGGeometryNode();
+        auto statusGeometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+        statusGeometry->setDrawingMode(GL_LINES);
+        status->setGeometry(statusGeometry);
+        status->setFlag(QSGNode::OwnsGeometry);
+        status->setMaterial(new QSGFlatColorMaterial());
+        status->setFlag(QSGNode::OwnsMaterial);
+        background->appendChildNode(status);
+
+        _geometryDirty = true;
+        _contentDirty = true;
+    }
+
+    if (_geometryDirty) {
+        auto radius = std::min(_radius, std::min(width(), height()) / 2);
+        const QPointF centers[] = {
+            QPointF(width() - radius, radius),
+            QPointF(width() - radius, height() - radius),
+            QPointF(radius, height() - radius),
+            QPointF(radius, radius)
+        };
+
+        auto geometry = background->geometry();
+        geometry->allocate(2 + 4 * (CORNER_SEGMENTS + 1));
+        auto vertices = geometry->vertexDataAsPoint2D();
+        vertices[0].set(width() / 2, height() / 2);
+        int i = 1;
+        for (int corner = 0; corner < 4; ++corner) {
+            for (int segment = 0; segment <= CORNER_SEGMENTS; ++segment) {
+                auto angle = M_PI / 2 * (corner - 1 + qreal(segment) / CORNER_SEGMENTS);
+                vertices[i++].set(centers[corner].x() + radius * qCos(angle), centers[corner].y() + radius * qSin(angle));
+            }
+        }
+        vertices[i] = vertices[1];
+
+        background->markDirty(QSGNode::DirtyGeometry);
+        _geometryDirty = false;
+    }
+
+    auto material = static_cast<QSGFlatColorMaterial*>(background->material());
+    if (material->color() != _backgroundColor) {
+        material->setColor(_backgroundColor);
+        background->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    if (_contentDirty && !_layoutDirty) {
+        updateContentNode(background);
+        _contentDirty = false;
+    }
+
+    return background;
+}
@@ -0,0 +1,139 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef TEXTBUBBLE_H
+#define TEXTBUBBLE_H
+
+#include <QQuickItem>
+#include <QSGGeometry>
+#include <QTextLayout>
+#include <QFont>
+#include <QColor>
+#include <QVector>
+
+class TextBubble : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QString text READ getText WRITE setText NOTIFY bubbleChanged)
+    Q_PROPERTY(QString author READ getAuthor WRITE setAuthor NOTIFY bubbleChanged)
+    Q_PROPERTY(QString time READ getTime WRITE setTime NOTIFY bubbleChanged)
+    Q_PROPERTY(bool isRead READ getIsRead WRITE setIsRead NOTIFY bubbleChanged)
+    Q_PROPERTY(bool received READ getReceived WRITE setReceived NOTIFY bubbleChanged)
+    Q_PROPERTY(QFont font READ getFont WRITE setFont NOTIFY bubbleChanged)
+    Q_PROPERTY(QFont timeFont READ getTimeFont WRITE setTimeFont NOTIFY bubbleChanged)
+    Q_PROPERTY(QColor color READ getColor WRITE setColor NOTIFY bubbleChanged)
+    Q_PROPERTY(QColor authorColor READ getAuthorColor WRITE setAuthorColor NOTIFY bubbleChanged)
+    Q_PROPERTY(QColor linkColor READ getLinkColor WRITE setLinkColor NOTIFY bubbleChanged)
+    Q_PROPERTY(QColor timeColor READ getTimeColor WRITE setTimeColor NOTIFY bubbleChanged)
+    Q_PROPERTY(QColor backgroundColor READ getBackgroundColor WRITE setBackgroundColor NOTIFY bubbleChanged)
+    Q_PROPERTY(qreal maximumWidth READ getMaximumWidth WRITE setMaximumWidth NOTIFY bubbleChanged)
+    Q_PROPERTY(qreal padding READ getPadding WRITE setPadding NOTIFY bubbleChanged)
+    Q_PROPERTY(qreal radius READ getRadius WRITE setRadius NOTIFY bubbleChanged)
+public:
+    TextBubble(QQuickItem *parent = nullptr);
+
+    QString getText() const;
+    void setText(QString text);
+    QString getAuthor() const;
+    void setAuthor(QString author);
+    QString getTime() const;
+    void setTime(QString time);
+    bool getIsRead() const;
+    void setIsRead(bool isRead);
+    bool getReceived() const;
+    void setReceived(bool received);
+    QFont getFont() const;
+    void setFont(QFont font);
+    QFont getTimeFont() const;
+    void setTimeFont(QFont timeFont);
+    QColor getColor() const;
+    void setColor(QColor color);
+    QColor getAuthorColor() const;
+    void setAuthorColor(QColor authorColor);
+    QColor getLinkColor() const;
+    void setLinkColor(QColor linkColor);
+    QColor getTimeColor() const;
+    void setTimeColor(QColor timeColor);
+    QColor getBackgroundColor() const;
+    void setBackgroundColor(QColor backgroundColor);
+    qreal getMaximumWidth() const;
+    void setMaximumWidth(qreal maximumWidth);
+    qreal getPadding() const;
+    void setPadding(qreal padding);
+    qreal getRadius() const;
+    void setRadius(qreal radius);
+
+    Q_INVOKABLE QString linkAt(qreal x, qreal y) const;
+
+signals:
+    void bubbleChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void updatePolish() override;
+
+private:
+    static const int WIDE_TEXT_LENGTH;
+    static const int CORNER_SEGMENTS;
+
+    struct TextLink
+    {
+        int start;
+        int length;
+        QString url;
+    };
+
+    void updateLayout();
+    void findLinks(const QString &text);
+    void updateContentNode(QSGNode *contentNode);
+    void updateStatusGeometry(QSGGeometry *geometry, const QRectF &rect) const;
+
+    QString _text;
+    QString _author;
+    QString _time;
+    bool _isRead = false;
+    bool _received = false;
+    QFont _font;
+    QFont _timeFont;
+    QColor _color = Qt::white;
+    QColor _authorColor = Qt::white;
+    QColor _linkColor = Qt::white;
+    QColor _timeColor = Qt::gray;
+    QColor _backgroundColor = Qt::transparent;
+    qreal _maximumWidth = 0;
+    qreal _padding = 0;
+    qreal _radius = 0;
+
+    QTextLayout _textLayout;
+    QTextLayout _authorLayout;
+    QTextLayout _timeLayout;
+    QVector<TextLink> _links;
+    qreal _authorHeight = 0;
+    qreal _textHeight = 0;
+    qreal _footerWidth = 0;
+    qreal _footerHeight = 0;
+    bool _layoutDirty = true;
+    bool _contentDirty = true;
+    bool _geometryDirty = true;
+};
+
+#endif // TEXTBUBBLE_H
@@ -0,0 +1,59 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "contentpool.h"
+
+ContentPool::ContentPool(int capacity) : _capacity(capacity)
+{
+}
+
+ContentPool::~ContentPool()
+{
+    for (auto &contents: _contents) qDeleteAll(contents);
+}
+
+QObject *ContentPool::take(qint32 contentTypeId)
+{
+    auto it = _contents.find(contentTypeId);
+    if (it == _contents.end() || it->isEmpty()) return nullptr;
+
+    return it->takeLast();
+}
+
+void ContentPool::recycle(qint32 contentTypeId, QObject *content)
+{
+    if (content == nullptr) return;
+
+    auto &contents = _contents[contentTypeId];
+    if (contents.size() >= _capacity) {
+        delete content;
+        return;
+    }
+
+    contents.append(content);
+}
+
+void ContentPool::setCapacity(int capacity)
+{
+    _capacity = capacity;
+    for (auto &contents: _contents) {
+        while (contents.size() > _capacity) delete contents.takeLast();
+    }
+}
@@ -0,0 +1,43 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONTENTPOOL_H
+#define CONTENTPOOL_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+
+class ContentPool
+{
+public:
+    explicit ContentPool(int capacity);
+    ~ContentPool();
+
+    QObject* take(qint32 contentTypeId);
+    void recycle(qint32 contentTypeId, QObject* content);
+    void setCapacity(int capacity);
+
+private:
+    QHash<qint32, QVector<QObject*>> _contents;
+    int _capacity;
+};
+
+#endif // CONTENTPOOL_H
@@ -25,6 +25,7 @@ along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
 #include <QtQml>
 #include "components/thumbnail.h"
 #include "components/audiorecorder.h"
+#include "components/textbubble.h"
 
 Core::Core(QObject *parent) : QObject(parent)
 {
@@ -33,9 +34,12 @@ Core::Core(QObject *parent) : QObject(parent)
     _users = make_shared<Users>();
     _files = make_shared<Files>();
     qRegisterMetaType<shared_ptr<td_api::Object>>();
+    qRegisterMetaType<QVector<qint64>>("QVector<qint64>");
+    qRegisterMetaType<QVector<int>>("QVector<int>");
     qmlRegisterType<User>("com.verdanditeam.user", 1, 0, "User");
     qmlRegisterType<Thumbnail>("com.verdanditeam.thumbnail", 1, 0, "Thumbnail");
     qmlRegisterType<AudioRecorder>("com.verdanditeam.audiorecorder", 1, 0, "AudioRecorder");
+    qmlRegisterType<TextBubble>("com.verdanditeam.textbubble", 1, 0, "TextBubble");
 
     _files->setTelegramManager(_manager);
     _files->setWifiAutoDownloadSettings(&_wifiAutoDownloadSettings);
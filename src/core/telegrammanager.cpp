@@ -35,6 +35,7 @@ void TelegramManager::init()
     connect(&receiver, SIGNAL(messageReceived(quint64, td_api::Object*)),
             this, SLOT(messageReceived(quint64, td_api::Object*)), Qt::DirectConnection);
     connect(this, SIGNAL(updateOption(td_api::updateOption*)), this, SLOT(onUpdateOption(td_api::updateOption*)));
+    connect(this, SIGNAL(updateConnectionState(td_api::updateConnectionState*)), this, SLOT(onUpdateConnectionState(td_api::updateConnectionState*)));
 
     connect(_networkManager, SIGNAL(defaultRouteChanged(NetworkService*)), this, SLOT(defaultRouteChanged(NetworkService*)));
     defaultRouteChanged(_networkManager->defaultRoute());
@@ -42,9 +43,11 @@ void TelegramManager::init()
     receiver.start();
 }
 
-void TelegramManager::sendQuery(td_api::Function* message)
+quint64 TelegramManager::sendQuery(td_api::Function* message)
 {
-    receiver.client->send({(std::uint64_t)1, std::move(td_api::object_ptr<td_api::Function>(message))});
+    auto id = ++_lastQueryId;
+    receiver.client->send({(std::uint64_t)id, std::move(td_api::object_ptr<td_api::Function>(message))});
+    return id;
 }
 
 qint32 TelegramManager::getMyId() const
@@ -52,6 +55,11 @@ qint32 TelegramManager::getMyId() const
     return _myId;
 }
 
+bool TelegramManager::isConnected() const
+{
+    return _isConnected;
+}
+
 bool TelegramManager::getDaemonEnabled() const
 {
     QSettings settings;
@@ -94,8 +102,8 @@ void TelegramManager::messageReceived(quint64 id, td_api::Object* message)
             [this](td_api::updateNewChat &newChat) {
                 emit this->updateNewChat(&newChat);
             },
-            [this](td_api::chats &chats) {
-                emit this->chats(&chats);
+            [this, id](td_api::chats &chats) {
+                emit this->chats(id, &chats);
             },
             [this](td_api::updateChatTitle &updateChatTitle) {
                 emit this->updateChatTitle(&updateChatTitle);
@@ -109,6 +117,9 @@ void TelegramManager::messageReceived(quint64 id, td_api::Object* message)
             [this](td_api::updateChatOrder &updateChatOrder) {
                 emit this->updateChatOrder(&updateChatOrder);
             },
+            [this](td_api::updateChatChatList &updateChatChatList) {
+                emit this->updateChatChatList(&updateChatChatList);
+            },
             [this](td_api::updateFile &updateFile) {
                 emit this->updateFile(&updateFile);
             },
@@ -118,11 +129,14 @@ void TelegramManager::messageReceived(quint64 id, td_api::Object* message)
             [this](td_api::updateChatReadOutbox &updateChatReadOutbox) {
                 emit this->updateChatReadOutbox(&updateChatReadOutbox);
             },
-            [this](td_api::message &message) {
-                emit this->message(&message);
+            [this](td_api::updateChatIsMarkedAsUnread &updateChatIsMarkedAsUnread) {
+                emit this->updateChatIsMarkedAsUnread(&updateChatIsMarkedAsUnread);
+            },
+            [this, id](td_api::messages &messages) {
+                emit this->messages(id, &messages);
             },
-            [this](td_api::messages &messages) {
-                emit this->messages(&messages);
+            [this, id](td_api::message &message) {
+                emit this->message(id, &message);
             },
             [this](td_api::updateNewMessage &updateNewMessage) {
                 emit this->updateNewMessage(&updateNewMessage);
@@ -187,6 +201,12 @@ void TelegramManager::messageReceived(quint64 id, td_api::Object* message)
             [this](td_api::stickerSet &stickerSet) {
                 emit this->stickerSet(&stickerSet);
             },
+            [this](td_api::updateConnectionState &updateConnectionState) {
+                emit this->updateConnectionState(&updateConnectionState);
+            },
+            [this, id](td_api::error &error) {
+                emit this->error(id, &error);
+            },
             [](auto &update) { Q_UNUSED(update) }
         )
     );
@@ -200,6 +220,15 @@ void TelegramManager::onUpdateOption(td_api::updateOption *updateOption)
     }
 }
 
+void TelegramManager::onUpdateConnectionState(td_api::updateConnectionState *updateConnectionState)
+{
+    auto isConnected = updateConnectionState->state_ != nullptr && updateConnectionState->state_->get_id() == td_api::connectionStateReady::ID;
+    if (_isConnected == isConnected) return;
+
+    _isConnected = isConnected;
+    emit connectedChanged(_isConnected);
+}
+
 void TelegramManager::defaultRouteChanged(NetworkService *networkService)
 {
     if (networkService == nullptr) {
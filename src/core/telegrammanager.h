@@ -35,8 +35,9 @@ public:
     TelegramManager();
 
     void init();
-    void sendQuery(td_api::Function* message);
+    quint64 sendQuery(td_api::Function* message);
     qint32 getMyId() const;
+    bool isConnected() const;
     bool getDaemonEnabled() const;
     void setDaemonEnabled(bool daemonEnabled);
     void setNetworkType(QString networkType);
@@ -46,16 +47,18 @@ signals:
     void onMessageReceived(quint64 id, td_api::Object* message);
     void send(td_api::Function* message);
     void updateNewChat(td_api::updateNewChat *newChat);
-    void chats(td_api::chats *chats);
+    void chats(quint64 id, td_api::chats *chats);
     void updateChatTitle(td_api::updateChatTitle *updateChatTitle);
     void updateChatPhoto(td_api::updateChatPhoto *updateChatPhoto);
     void updateChatLastMessage(td_api::updateChatLastMessage *updateChatLastMessage);
     void updateChatOrder(td_api::updateChatOrder *updateChatOrder);
+    void updateChatChatList(td_api::updateChatChatList *updateChatChatList);
     void updateFile(td_api::updateFile *updateFile);
     void updateChatReadInbox(td_api::updateChatReadInbox *updateChatReadInbox);
     void updateChatReadOutbox(td_api::updateChatReadOutbox *updateChatReadOutbox);
-    void message(td_api::message *message);
-    void messages(td_api::messages *messages);
+    void updateChatIsMarkedAsUnread(td_api::updateChatIsMarkedAsUnread *updateChatIsMarkedAsUnread);
+    void messages(quint64 id, td_api::messages *messages);
+    void message(quint64 id, td_api::message *message);
     void updateNewMessage(td_api::updateNewMessage *updateNewMessage);
     void updateUser(td_api::updateUser *updateUser);
     void updateMessageSendSucceeded(td_api::updateMessageSendSucceeded *updateMessageSendSucceeded);
@@ -77,12 +80,16 @@ signals:
     void updateInstalledStickerSets(td_api::updateInstalledStickerSets *updateInstalledStickerSets);
     void stickerSets(td_api::stickerSets *stickerSets);
     void stickerSet(td_api::stickerSet *stickerSet);
+    void updateConnectionState(td_api::updateConnectionState *updateConnectionState);
+    void error(quint64 id, td_api::error *error);
 
     void myIdChanged(qint32 myId);
+    void connectedChanged(bool connected);
 
 public slots:
     void messageReceived(quint64 id, td_api::Object* message);
     void onUpdateOption(td_api::updateOption *updateOption);
+    void onUpdateConnectionState(td_api::updateConnectionState *updateConnectionState);
     void defaultRouteChanged(NetworkService* networkService);
 
 private:
@@ -90,6 +97,8 @@ private:
     QThread receiverThread;
     QTimer incomingMessageCheckTimer;
     qint32 _myId;
+    bool _isConnected = false;
+    quint64 _lastQueryId = 1;
     NetworkManager* _networkManager;
     QString _networkType;
 };
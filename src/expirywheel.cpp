@@ -0,0 +1,120 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "expirywheel.h"
+#include <QDateTime>
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+
+const int ExpiryWheel::TICK_INTERVAL = 1000;
+const int ExpiryWheel::SLOT_BITS = 6;
+const int ExpiryWheel::SLOT_COUNT = 1 << SLOT_BITS;
+const int ExpiryWheel::LEVEL_COUNT = 4;
+
+ExpiryWheel::ExpiryWheel(QObject *parent) : QObject(parent)
+{
+    _slots.resize(SLOT_COUNT * LEVEL_COUNT);
+
+    _tickTimer.setInterval(TICK_INTERVAL);
+    connect(&_tickTimer, SIGNAL(timeout()), this, SLOT(onTick()));
+}
+
+void ExpiryWheel::schedule(qint64 chatId, qint64 messageId, double expiresIn)
+{
+    if (_count == 0) {
+        _currentTick = 0;
+        _startTime = QDateTime::currentMSecsSinceEpoch();
+        _tickTimer.start();
+    }
+
+    auto elapsedTicks = quint64(QDateTime::currentMSecsSinceEpoch() - _startTime) / TICK_INTERVAL;
+    auto ticks = std::max<quint64>(1, std::ceil(expiresIn * 1000 / TICK_INTERVAL));
+    insert({chatId, messageId, std::max(_currentTick, elapsedTicks) + ticks});
+    ++_count;
+}
+
+int ExpiryWheel::count() const
+{
+    return _count;
+}
+
+void ExpiryWheel::insert(const ExpiryEntry &entry)
+{
+    // An entry lives on the lowest level whose parent slot it shares with the current tick,
+    // so it is cascaded down exactly when the wheel reaches that parent slot.
+    int level = 0;
+    while (level < LEVEL_COUNT - 1 && (entry.expiresAt >> (SLOT_BITS * (level + 1))) != (_currentTick >> (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    auto slot = (entry.expiresAt >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+    _slots[level * SLOT_COUNT + slot].append(entry);
+}
+
+void ExpiryWheel::advance(QVector<ExpiryEntry> &expired)
+{
+    ++_currentTick;
+
+    for (int level = 1; level < LEVEL_COUNT; ++level) {
+        if ((_currentTick & ((quint64(1) << (SLOT_BITS * level)) - 1)) != 0) break;
+
+        auto slot = (_currentTick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+        QVector<ExpiryEntry> entries;
+        entries.swap(_slots[level * SLOT_COUNT + slot]);
+        for (auto &entry: entries) {
+            insert(entry);
+        }
+    }
+
+    auto &entries = _slots[_currentTick & (SLOT_COUNT - 1)];
+    for (int i = 0; i < entries.size();) {
+        if (entries[i].expiresAt <= _currentTick) {
+            expired.append(entries[i]);
+            entries[i] = entries.last();
+            entries.removeLast();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void ExpiryWheel::onTick()
+{
+    auto elapsedTicks = quint64(QDateTime::currentMSecsSinceEpoch() - _startTime) / TICK_INTERVAL;
+
+    QVector<ExpiryEntry> expired;
+    while (_currentTick < elapsedTicks && _count > expired.size()) {
+        advance(expired);
+    }
+    if (_count == expired.size()) _currentTick = elapsedTicks;
+
+    _count -= expired.size();
+    if (_count == 0) _tickTimer.stop();
+    if (expired.isEmpty()) return;
+
+    QHash<qint64, QVector<qint64>> expiredMessages;
+    for (auto &entry: expired) {
+        expiredMessages[entry.chatId].append(entry.messageId);
+    }
+    for (auto it = expiredMessages.constBegin(); it != expiredMessages.constEnd(); ++it) {
+        emit messagesExpired(it.key(), it.value());
+    }
+}
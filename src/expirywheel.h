@@ -0,0 +1,66 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef EXPIRYWHEEL_H
+#define EXPIRYWHEEL_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+struct ExpiryEntry
+{
+    qint64 chatId;
+    qint64 messageId;
+    quint64 expiresAt;
+};
+
+class ExpiryWheel : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ExpiryWheel(QObject *parent = nullptr);
+
+    void schedule(qint64 chatId, qint64 messageId, double expiresIn);
+    int count() const;
+
+signals:
+    void messagesExpired(qint64 chatId, QVector<qint64> messageIds);
+
+public slots:
+    void onTick();
+
+private:
+    static const int TICK_INTERVAL;
+    static const int SLOT_BITS;
+    static const int SLOT_COUNT;
+    static const int LEVEL_COUNT;
+
+    void insert(const ExpiryEntry &entry);
+    void advance(QVector<ExpiryEntry> &expired);
+
+    QVector<QVector<ExpiryEntry>> _slots;
+    quint64 _currentTick = 0;
+    qint64 _startTime = 0;
+    int _count = 0;
+    QTimer _tickTimer;
+};
+
+#endif // EXPIRYWHEEL_H
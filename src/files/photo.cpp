@@ -30,6 +30,9 @@ Photo::Photo(QObject *parent) : ContentFile(parent)
 void Photo::setPhoto(td_api::object_ptr<td_api::messagePhoto> messagePhoto)
 {
     _photo = std::move(messagePhoto);
+    _photoSizesTypes.clear();
+    _photoSizes.clear();
+    _photoSizeFileIds.clear();
 
     addUpdateFiles();
 
@@ -19,33 +19,59 @@ along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "message.h"
+#include <QQmlEngine>
 
-Message::Message(QObject *parent) : QObject(parent), _message(nullptr), _text(nullptr), _webPage(nullptr), _poll(nullptr), _photo(nullptr), _sticker(nullptr),
-    _video(nullptr), _document(nullptr), _audio(nullptr), _animation(nullptr), _voiceNote(nullptr), _videoNote(nullptr)
+const qint64 Message::CONTENT_MEMORY_USAGE = 1024;
+
+Message::Message(QObject *parent) : QObject(parent), _contentTypeId(0), _content(nullptr), _contentPool(nullptr)
 {
 
 }
 
 Message::~Message()
 {
+    delete _content;
+}
+
+void Message::clear()
+{
+    if (_contentPool != nullptr) _contentPool->recycle(_contentTypeId, _content);
+    else delete _content;
+    _content = nullptr;
+    _messageContent = nullptr;
+    _record = MessageRecord();
+    _contentTypeId = 0;
+    _display = MessageDisplay();
 }
 
-td_api::message *Message::message() const
+void Message::setMessage(td_api::object_ptr<td_api::message> message)
 {
-    return _message;
+    readMessage(message.get());
+    _contentTypeId = message->content_ == nullptr ? 0 : message->content_->get_id();
+    _messageContent = std::move(message->content_);
+    updateDisplay();
 }
 
-void Message::setMessage(td_api::message *message)
+void Message::replaceMessage(td_api::object_ptr<td_api::message> message)
 {
-    _message = message;
+    auto oldMessageId = getId();
+    readMessage(message.get());
     handleMessageContent(std::move(message->content_));
+    emit messageIdChanged(oldMessageId, getId());
+    emit contentChanged(getId());
+}
+
+void Message::updateRecord(td_api::message *message)
+{
+    auto oldMessageId = getId();
+    readMessage(message);
+    emit messageIdChanged(oldMessageId, getId());
+    emit contentChanged(getId());
 }
 
 void Message::setTelegramManager(shared_ptr<TelegramManager> manager)
 {
     _manager = manager;
-    connect(this->_manager.get(), SIGNAL(updateMessageSendSucceeded(td_api::updateMessageSendSucceeded*)), this, SLOT(updateMessageSendSucceeded(td_api::updateMessageSendSucceeded*)));
-    connect(this->_manager.get(), SIGNAL(updateMessageContent(td_api::updateMessageContent*)), this, SLOT(updateMessageContent(td_api::updateMessageContent*)));
 }
 
 void Message::setUsers(shared_ptr<Users> users)
@@ -58,100 +84,152 @@ void Message::setFiles(shared_ptr<Files> files)
     _files = files;
 }
 
+void Message::setContentPool(ContentPool *contentPool)
+{
+    _contentPool = contentPool;
+}
+
+void Message::readMessage(td_api::message *message)
+{
+    _record.id = message->id_;
+    _record.replyToMessageId = message->reply_to_message_id_;
+    _record.ttlExpiresIn = message->ttl_expires_in_;
+    _record.senderUserId = message->sender_user_id_;
+    _record.date = message->date_;
+    _record.editDate = message->edit_date_;
+    _record.views = message->views_;
+    _record.ttl = message->ttl_;
+    _record.isOutgoing = message->is_outgoing_;
+    _record.canBeEdited = message->can_be_edited_;
+    _record.canBeForwarded = message->can_be_forwarded_;
+    _record.canBeDeletedForAllUsers = message->can_be_deleted_for_all_users_;
+    _record.isChannelPost = message->is_channel_post_;
+    _record.isForwarded = message->forward_info_ != nullptr;
+
+    _display.forwardUserId = 0;
+    _display.forwardUsername = "";
+    _display.forwardChannelId = 0;
+    if (message->forward_info_ != nullptr) {
+        switch (message->forward_info_->origin_->get_id()) {
+        case td_api::messageForwardOriginUser::ID:
+            _display.forwardUserId = static_cast<const td_api::messageForwardOriginUser&>(*message->forward_info_->origin_).sender_user_id_;
+            break;
+        case td_api::messageForwardOriginHiddenUser::ID:
+            _display.forwardUsername = QString::fromStdString(static_cast<const td_api::messageForwardOriginHiddenUser&>(*message->forward_info_->origin_).sender_name_);
+            break;
+        case td_api::messageForwardOriginChannel::ID:
+            _display.forwardChannelId = static_cast<const td_api::messageForwardOriginChannel&>(*message->forward_info_->origin_).chat_id_;
+            break;
+        }
+    }
+}
+
 qint64 Message::getId()
 {
-    return _message->id_;
+    return _record.id;
 }
 
 QString Message::getText()
 {
-    switch (_contentTypeId) {
+    return _display.text;
+}
+
+QString Message::formatText(td_api::MessageContent *content, qint32 senderUserId, shared_ptr<Users> users)
+{
+    if (content == nullptr) return "";
+
+    switch (content->get_id()) {
     case td_api::messageText::ID:
-        return QString::fromStdString(_text->text_->text_);
+        return QString::fromStdString(static_cast<td_api::messageText*>(content)->text_->text_);
     case td_api::messageChatDeleteMember::ID:
-        return tr("%1 left").arg(_users->getUser(getDeleteMemberId())->getName());
+        return tr("%1 left").arg(users->getUser(static_cast<td_api::messageChatDeleteMember*>(content)->user_id_)->getName());
     case td_api::messageChatAddMembers::ID:
     {
-        auto newUsers = getAddMembersIds();
+        auto &newUsers = static_cast<td_api::messageChatAddMembers*>(content)->member_user_ids_;
         for(auto userId: newUsers) {
-            return tr("%1 joined").arg(_users->getUser(userId)->getName());
+            return tr("%1 joined").arg(users->getUser(userId)->getName());
         }
         return "";
     }
     case td_api::messageChatJoinByLink::ID:
-        return tr("%1 joined").arg(_users->getUser(getSenderUserId())->getName());
+        return tr("%1 joined").arg(users->getUser(senderUserId)->getName());
     case td_api::messagePhoto::ID:
-        if (_photo->getCaption() == nullptr) return "";
-        return QString::fromStdString(_photo->getCaption()->text_);
+        return getCaption(static_cast<td_api::messagePhoto*>(content)->caption_.get());
     case td_api::messageSticker::ID:
         return "";
     case td_api::messageVideo::ID:
-        if (_video->getCaption() == nullptr) return "";
-        return QString::fromStdString(_video->getCaption()->text_);
+        return getCaption(static_cast<td_api::messageVideo*>(content)->caption_.get());
     case td_api::messageDocument::ID:
-        if (_document->getCaption() == nullptr) return "";
-        return QString::fromStdString(_document->getCaption()->text_);
+        return getCaption(static_cast<td_api::messageDocument*>(content)->caption_.get());
     case td_api::messageAudio::ID:
-        if (_audio->getCaption() == nullptr) return "";
-        return QString::fromStdString(_audio->getCaption()->text_);
+        return getCaption(static_cast<td_api::messageAudio*>(content)->caption_.get());
     case td_api::messageAnimation::ID:
-        if (_animation->getCaption() == nullptr) return "";
-        return QString::fromStdString(_animation->getCaption()->text_);
+        return getCaption(static_cast<td_api::messageAnimation*>(content)->caption_.get());
     case td_api::messageVoiceNote::ID:
-        if (_voiceNote->getCaption() == nullptr) return "";
-        return QString::fromStdString(_voiceNote->getCaption()->text_);
+        return getCaption(static_cast<td_api::messageVoiceNote*>(content)->caption_.get());
     case td_api::messageVideoNote::ID:
         return "";
     case td_api::messagePoll::ID:
-        return _poll->getQuestion();
+        return QString::fromStdString(static_cast<td_api::messagePoll*>(content)->poll_->question_);
     case td_api::messageChatSetTtl::ID:
-        return tr("Self-destruct timer set to %n second(s)", "", static_cast<td_api::messageChatSetTtl*>(_message->content_.get())->ttl_);
+        return tr("Self-destruct timer set to %n second(s)", "", static_cast<td_api::messageChatSetTtl*>(content)->ttl_);
     case td_api::messagePinMessage::ID:
-        return tr("%1 pinned message").arg(_users->getUser(getSenderUserId())->getName());
+        return tr("%1 pinned message").arg(users->getUser(senderUserId)->getName());
     default:
         return "Message unsupported";
     }
 }
 
+QString Message::getCaption(td_api::formattedText *caption)
+{
+    if (caption == nullptr) return "";
+    return QString::fromStdString(caption->text_);
+}
+
 QString Message::getType()
 {
-    switch (_contentTypeId) {
+    return _display.type;
+}
+
+QString Message::formatType(qint32 contentTypeId)
+{
+    switch (contentTypeId) {
     case td_api::messageChatDeleteMember::ID:
-        return "messageChatDeleteMember";
+        return QStringLiteral("messageChatDeleteMember");
     case td_api::messageChatAddMembers::ID:
-        return "messageChatAddMembers";
+        return QStringLiteral("messageChatAddMembers");
     case td_api::messageChatJoinByLink::ID:
-        return "messageChatJoinByLink";
+        return QStringLiteral("messageChatJoinByLink");
     case td_api::messageText::ID:
-        return "text";
+        return QStringLiteral("text");
     case td_api::messagePhoto::ID:
-        return "photo";
+        return QStringLiteral("photo");
     case td_api::messageAnimation::ID:
-        return "animation";
+        return QStringLiteral("animation");
     case td_api::messageSticker::ID:
-        return "sticker";
+        return QStringLiteral("sticker");
     case td_api::messageVideo::ID:
-        return "video";
+        return QStringLiteral("video");
     case td_api::messageVideoNote::ID:
-        return "videoNote";
+        return QStringLiteral("videoNote");
     case td_api::messageAudio::ID:
-        return "audio";
+        return QStringLiteral("audio");
     case td_api::messageVoiceNote::ID:
-        return "voiceNote";
+        return QStringLiteral("voiceNote");
     case td_api::messageDocument::ID:
-        return "document";
+        return QStringLiteral("document");
     case td_api::messagePoll::ID:
-        return "poll";
+        return QStringLiteral("poll");
     case td_api::messageChatSetTtl::ID:
-        return "chatSetTtl";
+        return QStringLiteral("chatSetTtl");
     case td_api::messageCustomServiceAction::ID:
-        return "messageCustomServiceAction";
+        return QStringLiteral("messageCustomServiceAction");
     case td_api::messagePinMessage::ID:
-        return "pinMessage";
+        return QStringLiteral("pinMessage");
     case td_api::messageUnsupported::ID:
-        return "messageUnsupported";
+        return QStringLiteral("messageUnsupported");
     default:
-        return "Message unsupported";
+        return QStringLiteral("Message unsupported");
     }
 }
 
@@ -162,48 +240,48 @@ qint32 Message::getContentType()
 
 bool Message::isEdited()
 {
-    return _message->edit_date_ != 0;
+    return _record.editDate != 0;
 }
 
 bool Message::canBeEdited()
 {
-    return _message->can_be_edited_;
+    return _record.canBeEdited;
 }
 
 bool Message::canBeForwarded()
 {
-    return _message->can_be_forwarded_;
+    return _record.canBeForwarded;
 }
 
 bool Message::canBeDeleted()
 {
-    return _message->can_be_deleted_for_all_users_;
+    return _record.canBeDeletedForAllUsers;
 }
 
 bool Message::isChannelPost()
 {
-    return _message->is_channel_post_;
+    return _record.isChannelPost;
 }
 
 int Message::getEditedDate()
 {
-    return _message->edit_date_;
+    return _record.editDate;
 }
 
 int Message::getViews()
 {
-    return _message->views_;
+    return _record.views;
 }
 
 bool Message::received()
 {
-    return !_message->is_outgoing_;
+    return !_record.isOutgoing;
 }
 
 qint32 Message::getDeleteMemberId()
 {
     if (_contentTypeId == td_api::messageChatDeleteMember::ID) {
-        return static_cast<const td_api::messageChatDeleteMember &>(*_message->content_).user_id_;
+        return static_cast<const td_api::messageChatDeleteMember &>(*_messageContent).user_id_;
     }
 
     return -1;
@@ -214,7 +292,7 @@ QVector<qint32> Message::getAddMembersIds()
     QVector<qint32> newUsers;
 
     if (_contentTypeId == td_api::messageChatAddMembers::ID) {
-        auto userIds = static_cast<const td_api::messageChatAddMembers &>(*_message->content_).member_user_ids_;
+        auto userIds = static_cast<const td_api::messageChatAddMembers &>(*_messageContent).member_user_ids_;
 
         for(qint32 userId: userIds) {
             newUsers.append(userId);
@@ -226,203 +304,218 @@ QVector<qint32> Message::getAddMembersIds()
 
 qint64 Message::replyMessageId()
 {
-    return _message->reply_to_message_id_;
+    return _record.replyToMessageId;
 }
 
-td_api::messageForwardInfo* Message::getForwardedInfo()
+bool Message::isForwarded()
 {
-    return _message->forward_info_.get();
+    return _record.isForwarded;
 }
 
-qint32 Message::getSenderUserId()
+qint32 Message::getTtl()
 {
-    return _message->sender_user_id_;
+    return _record.ttl;
 }
 
-QString Message::getFormattedTimestamp()
+double Message::getTtlExpiresIn()
 {
-    return QDateTime::fromTime_t(static_cast<uint>(_message->date_)).toString("hh:mm");
+    return _record.ttlExpiresIn;
 }
 
-bool Message::hasWebPage() const
+qint32 Message::getSenderUserId()
 {
-    return _webPage != nullptr;
+    return _record.senderUserId;
 }
 
-WebPage* Message::getWebPage() const
+QString Message::getFormattedTimestamp()
 {
-    return _webPage;
+    return QDateTime::fromTime_t(static_cast<uint>(_record.date)).toString("hh:mm");
 }
 
-Poll *Message::getPoll() const
+const MessageDisplay &Message::getDisplay() const
 {
-    return _poll;
+    return _display;
 }
 
-Photo *Message::getPhoto() const
+qint64 Message::getMemoryUsage() const
 {
-    return _photo;
+    qint64 usage = sizeof(Message);
+    usage += (_display.text.size() + _display.type.size() + _display.time.size() + _display.forwardUsername.size()) * sizeof(QChar);
+    if (_content != nullptr) usage += CONTENT_MEMORY_USAGE;
+    return usage;
 }
 
-Sticker *Message::getSticker() const
+void Message::updateDisplay()
 {
-    return _sticker;
+    _display.text = formatText(_messageContent.get(), _record.senderUserId, _users);
+    _display.type = formatType(_contentTypeId);
+    _display.time = getFormattedTimestamp();
+    _display.hasWebPage = _contentTypeId == td_api::messageText::ID
+            && (static_cast<td_api::messageText*>(_messageContent.get())->web_page_ != nullptr || _content != nullptr);
 }
 
-Video *Message::getVideo() const
+bool Message::hasWebPage() const
 {
-    return _video;
+    return _display.hasWebPage;
 }
 
-Document *Message::getDocument() const
+QVariant Message::getFile()
 {
-    return _document;
+    switch (_contentTypeId) {
+    case td_api::messagePhoto::ID:
+    case td_api::messageSticker::ID:
+    case td_api::messageVideo::ID:
+    case td_api::messageDocument::ID:
+    case td_api::messageAudio::ID:
+    case td_api::messageAnimation::ID:
+    case td_api::messageVoiceNote::ID:
+    case td_api::messageVideoNote::ID:
+        return QVariant::fromValue(getContent());
+    default:
+        return QVariant();
+    }
 }
 
-Audio *Message::getAudio() const
+QVariant Message::getWebPage()
 {
-    return _audio;
+    if (_contentTypeId != td_api::messageText::ID) return QVariant::fromValue(static_cast<WebPage*>(nullptr));
+    return QVariant::fromValue(qobject_cast<WebPage*>(getContent()));
 }
 
-Animation *Message::getAnimation() const
+QVariant Message::getPoll()
 {
-    return _animation;
+    if (_contentTypeId != td_api::messagePoll::ID) return QVariant::fromValue(static_cast<Poll*>(nullptr));
+    return QVariant::fromValue(qobject_cast<Poll*>(getContent()));
 }
 
-VoiceNote *Message::getVoiceNote() const
+QObject *Message::getContent()
 {
-    return _voiceNote;
-}
+    if (_content != nullptr || _messageContent == nullptr) return _content;
 
-VideoNote *Message::getVideoNote() const
-{
-    return _videoNote;
+    _content = createContent();
+    if (_content != nullptr) {
+        QQmlEngine::setObjectOwnership(_content, QQmlEngine::CppOwnership);
+        moveContent();
+    }
+
+    return _content;
 }
 
-void Message::handleMessageContent(td_api::object_ptr<td_api::MessageContent> messageContent)
+QObject *Message::createContent()
 {
-    if (messageContent == nullptr) return;
-    _contentTypeId = messageContent->get_id();
-    switch (_contentTypeId) {
-    case td_api::messageText::ID:
-        if (static_cast<td_api::messageText*>(messageContent.get())->web_page_ != nullptr) {
-            if (_webPage == nullptr)
-                _webPage = new WebPage();
+    if (_contentTypeId == td_api::messageText::ID && static_cast<td_api::messageText*>(_messageContent.get())->web_page_ == nullptr) return nullptr;
 
-            _webPage->setWebpage(std::move(static_cast<td_api::messageText*>(messageContent.get())->web_page_));
-        }
+    if (_contentPool != nullptr) {
+        auto content = _contentPool->take(_contentTypeId);
+        if (content != nullptr) return content;
+    }
 
-        _text = td_api::move_object_as<td_api::messageText>(messageContent);
-        break;
+    ContentFile* file = nullptr;
+    switch (_contentTypeId) {
+    case td_api::messageText::ID:
+        return new WebPage();
+    case td_api::messagePoll::ID:
+        return new Poll();
     case td_api::messagePhoto::ID:
-    {
-        if (_photo == nullptr) {
-            _photo = new Photo();
-            _photo->setTelegramManager(_manager);
-            _photo->setFiles(_files);
-        }
-        _photo->setPhoto(td_api::move_object_as<td_api::messagePhoto>(messageContent));
-    }
+        file = new Photo();
         break;
     case td_api::messageSticker::ID:
-    {
-        if (_sticker == nullptr) {
-            _sticker = new Sticker();
-            _sticker->setTelegramManager(_manager);
-            _sticker->setFiles(_files);
-        }
-        _sticker->setSticker(td_api::move_object_as<td_api::messageSticker>(messageContent));
-    }
+        file = new Sticker();
         break;
     case td_api::messageVideo::ID:
-    {
-        if (_video == nullptr) {
-            _video = new Video();
-            _video->setTelegramManager(_manager);
-            _video->setFiles(_files);
-        }
-        _video->setVideo(td_api::move_object_as<td_api::messageVideo>(messageContent));
-    }
+        file = new Video();
         break;
     case td_api::messageDocument::ID:
-    {
-        if (_document == nullptr) {
-            _document = new Document();
-            _document->setTelegramManager(_manager);
-            _document->setFiles(_files);
-        }
-        _document->setDocument(td_api::move_object_as<td_api::messageDocument>(messageContent));
-    }
+        file = new Document();
         break;
     case td_api::messageAudio::ID:
-    {
-        if (_audio == nullptr) {
-            _audio = new Audio();
-            _audio->setTelegramManager(_manager);
-            _audio->setFiles(_files);
-        }
-        _audio->setAudio(td_api::move_object_as<td_api::messageAudio>(messageContent));
-    }
+        file = new Audio();
         break;
     case td_api::messageAnimation::ID:
-    {
-        if (_animation == nullptr) {
-            _animation = new Animation();
-            _animation->setTelegramManager(_manager);
-            _animation->setFiles(_files);
-        }
-        _animation->setAnimation(td_api::move_object_as<td_api::messageAnimation>(messageContent));
-    }
+        file = new Animation();
         break;
     case td_api::messageVoiceNote::ID:
-    {
-        if (_voiceNote == nullptr) {
-            _voiceNote = new VoiceNote();
-            _voiceNote->setTelegramManager(_manager);
-            _voiceNote->setFiles(_files);
-        }
-        _voiceNote->setVoiceNote(td_api::move_object_as<td_api::messageVoiceNote>(messageContent));
-    }
+        file = new VoiceNote();
         break;
     case td_api::messageVideoNote::ID:
+        file = new VideoNote();
+        break;
+    default:
+        return nullptr;
+    }
+
+    file->setTelegramManager(_manager);
+    file->setFiles(_files);
+    return file;
+}
+
+void Message::moveContent()
+{
+    switch (_contentTypeId) {
+    case td_api::messageText::ID:
     {
-        if (_videoNote == nullptr) {
-            _videoNote = new VideoNote();
-            _videoNote->setTelegramManager(_manager);
-            _videoNote->setFiles(_files);
-        }
-        _videoNote->setVideoNote(td_api::move_object_as<td_api::messageVideoNote>(messageContent));
+        auto text = static_cast<td_api::messageText*>(_messageContent.get());
+        if (text->web_page_ != nullptr) static_cast<WebPage*>(_content)->setWebpage(std::move(text->web_page_));
     }
         break;
     case td_api::messagePoll::ID:
-    {
-        if (_poll == nullptr)
-            _poll = new Poll();
-
-        _poll->setPoll(std::move(static_cast<td_api::messagePoll*>(messageContent.get())->poll_));
-    }
+        static_cast<Poll*>(_content)->setPoll(std::move(static_cast<td_api::messagePoll*>(_messageContent.get())->poll_));
         break;
-    default:
-        _message->content_ = move(messageContent);
+    case td_api::messagePhoto::ID:
+        static_cast<Photo*>(_content)->setPhoto(td_api::move_object_as<td_api::messagePhoto>(_messageContent));
+        break;
+    case td_api::messageSticker::ID:
+        static_cast<Sticker*>(_content)->setSticker(td_api::move_object_as<td_api::messageSticker>(_messageContent));
+        break;
+    case td_api::messageVideo::ID:
+        static_cast<Video*>(_content)->setVideo(td_api::move_object_as<td_api::messageVideo>(_messageContent));
+        break;
+    case td_api::messageDocument::ID:
+        static_cast<Document*>(_content)->setDocument(td_api::move_object_as<td_api::messageDocument>(_messageContent));
+        break;
+    case td_api::messageAudio::ID:
+        static_cast<Audio*>(_content)->setAudio(td_api::move_object_as<td_api::messageAudio>(_messageContent));
+        break;
+    case td_api::messageAnimation::ID:
+        static_cast<Animation*>(_content)->setAnimation(td_api::move_object_as<td_api::messageAnimation>(_messageContent));
+        break;
+    case td_api::messageVoiceNote::ID:
+        static_cast<VoiceNote*>(_content)->setVoiceNote(td_api::move_object_as<td_api::messageVoiceNote>(_messageContent));
+        break;
+    case td_api::messageVideoNote::ID:
+        static_cast<VideoNote*>(_content)->setVideoNote(td_api::move_object_as<td_api::messageVideoNote>(_messageContent));
+        break;
+    }
+}
+
+void Message::handleMessageContent(td_api::object_ptr<td_api::MessageContent> messageContent)
+{
+    if (messageContent == nullptr) return;
+
+    auto contentTypeId = messageContent->get_id();
+    auto hasWebPage = contentTypeId == td_api::messageText::ID && static_cast<td_api::messageText*>(messageContent.get())->web_page_ != nullptr;
+    if (_content != nullptr && (contentTypeId != _contentTypeId || (contentTypeId == td_api::messageText::ID && !hasWebPage))) {
+        _content->deleteLater();
+        _content = nullptr;
     }
+    _contentTypeId = contentTypeId;
+    _messageContent = move(messageContent);
+    updateDisplay();
+
+    if (_content != nullptr) moveContent();
 }
 
 void Message::updateMessageSendSucceeded(td_api::updateMessageSendSucceeded *updateMessageSendSucceeded)
 {
     if (updateMessageSendSucceeded->message_ != nullptr && updateMessageSendSucceeded->old_message_id_ == getId()) {
-        _message = updateMessageSendSucceeded->message_.release();
-        handleMessageContent(std::move(_message->content_));
-        emit messageIdChanged(updateMessageSendSucceeded->old_message_id_, getId());
-        emit contentChanged(getId());
+        replaceMessage(std::move(updateMessageSendSucceeded->message_));
     }
 }
 
 void Message::updateMessageContent(td_api::updateMessageContent *updateMessageContent)
 {
     if (updateMessageContent->message_id_ == this->getId() && updateMessageContent->chat_id_ == getChatId()) {
-        _message->content_.release();
-        _message->content_ = move(updateMessageContent->new_content_);
-        handleMessageContent(std::move(_message->content_));
+        handleMessageContent(std::move(updateMessageContent->new_content_));
         emit contentChanged(this->getId());
     }
 }
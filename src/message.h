@@ -39,6 +39,36 @@ along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
 #include "users.h"
 #include "webpage.h"
 #include "poll.h"
+#include "contentpool.h"
+
+struct MessageDisplay
+{
+    QString text;
+    QString type;
+    QString time;
+    bool hasWebPage = false;
+    qint32 forwardUserId = 0;
+    QString forwardUsername;
+    qint64 forwardChannelId = 0;
+};
+
+struct MessageRecord
+{
+    qint64 id = 0;
+    qint64 replyToMessageId = 0;
+    double ttlExpiresIn = 0;
+    qint32 senderUserId = 0;
+    qint32 date = 0;
+    qint32 editDate = 0;
+    qint32 views = 0;
+    qint32 ttl = 0;
+    bool isOutgoing = false;
+    bool canBeEdited = false;
+    bool canBeForwarded = false;
+    bool canBeDeletedForAllUsers = false;
+    bool isChannelPost = false;
+    bool isForwarded = false;
+};
 
 class Message : public QObject
 {
@@ -47,11 +77,14 @@ public:
     explicit Message(QObject *parent = nullptr);
     ~Message();
 
-    td_api::message *message() const;
-    void setMessage(td_api::message *message);
+    void setMessage(td_api::object_ptr<td_api::message> message);
+    void replaceMessage(td_api::object_ptr<td_api::message> message);
+    void updateRecord(td_api::message *message);
+    void clear();
     void setTelegramManager(shared_ptr<TelegramManager> manager);
     void setUsers(shared_ptr<Users> users);
     void setFiles(shared_ptr<Files> files);
+    void setContentPool(ContentPool* contentPool);
 
     qint64 getId();
     QString getText();
@@ -68,54 +101,53 @@ public:
     qint32 getDeleteMemberId();
     QVector<qint32> getAddMembersIds();
     qint64 replyMessageId();
-    td_api::messageForwardInfo* getForwardedInfo();
+    bool isForwarded();
+    qint32 getTtl();
+    double getTtlExpiresIn();
     qint32 getSenderUserId();
     QString getFormattedTimestamp();
+    const MessageDisplay &getDisplay() const;
+    qint64 getMemoryUsage() const;
+    void updateDisplay();
+    static QString formatText(td_api::MessageContent *content, qint32 senderUserId, shared_ptr<Users> users);
+    static QString formatType(qint32 contentTypeId);
 
     bool hasWebPage() const;
-    WebPage* getWebPage() const;
-    Poll* getPoll() const;
-    Photo* getPhoto() const;
-    Sticker* getSticker() const;
-    Video* getVideo() const;
-    Document* getDocument() const;
-    Audio* getAudio() const;
-    Animation* getAnimation() const;
-    VoiceNote* getVoiceNote() const;
-    VideoNote* getVideoNote() const;
+    QVariant getFile();
+    QVariant getWebPage();
+    QVariant getPoll();
 
     void handleMessageContent(td_api::object_ptr<td_api::MessageContent> messageContent);
 
     qint64 getChatId() const;
     void setChatId(const qint64 &chatId);
 
+    void updateMessageSendSucceeded(td_api::updateMessageSendSucceeded *updateMessageSendSucceeded);
+    void updateMessageContent(td_api::updateMessageContent *updateMessageContent);
+
 signals:
     void contentChanged(qint64 messageId);
     void messageIdChanged(qint64 oldMessageId, qint64 newMessageId);
 
-public slots:
-    void updateMessageSendSucceeded(td_api::updateMessageSendSucceeded *updateMessageSendSucceeded);
-    void updateMessageContent(td_api::updateMessageContent *updateMessageContent);
-
 private:
+    static const qint64 CONTENT_MEMORY_USAGE;
+
+    void readMessage(td_api::message *message);
+    static QString getCaption(td_api::formattedText* caption);
+    QObject* getContent();
+    QObject* createContent();
+    void moveContent();
+
     qint64 _chatId;
-    td_api::message* _message;
+    MessageRecord _record;
     qint32 _contentTypeId;
-    QVector<qint32> _file_ids;
+    td_api::object_ptr<td_api::MessageContent> _messageContent;
     shared_ptr<TelegramManager> _manager;
     shared_ptr<Users> _users;
     shared_ptr<Files> _files;
-    td_api::object_ptr<td_api::messageText> _text;
-    WebPage* _webPage;
-    Poll* _poll;
-    Photo* _photo;
-    Sticker* _sticker;
-    Video* _video;
-    Document* _document;
-    Audio* _audio;
-    Animation* _animation;
-    VoiceNote* _voiceNote;
-    VideoNote* _videoNote;
+    QObject* _content;
+    ContentPool* _contentPool;
+    MessageDisplay _display;
 };
 
 #endif // MESSAGE_H
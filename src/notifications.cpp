@@ -69,10 +69,11 @@ void Notifications::updateActiveNotifications(td_api::updateActiveNotifications
 
 void Notifications::updateNotificationGroup(td_api::updateNotificationGroup *updateNotificationGroup)
 {
-    Chat* chat = _chatList->getChat(updateNotificationGroup->chat_id_);
+    auto chat = _chatList->getChatSummary(updateNotificationGroup->chat_id_);
+    if (chat == nullptr) return;
 
     for (auto& notification : updateNotificationGroup->added_notifications_) {
-        if (chat->isOpen() || notification->is_silent_) continue;
+        if (chat->isOpen || notification->is_silent_) continue;
         switch (notification->type_.get()->get_id()) {
         case td_api::notificationTypeNewMessage::ID:
         {
@@ -80,7 +81,7 @@ void Notifications::updateNotificationGroup(td_api::updateNotificationGroup *upd
             Message message;
             message.setFiles(_files);
             message.setUsers(_users);
-            message.setMessage(newMessage->message_.get());
+            message.setMessage(std::move(newMessage->message_));
             shared_ptr<User> user = _users->getUser(message.getSenderUserId());
             if (user == nullptr) continue;
 
@@ -105,9 +106,6 @@ void Notifications::updateNotificationGroup(td_api::updateNotificationGroup *upd
         case td_api::notificationTypeNewSecretChat::ID:
         {
             td_api::notificationTypeNewSecretChat* newSecretChat = static_cast<td_api::notificationTypeNewSecretChat*>(notification->type_.get());
-            auto chat = _chatList->getChat(updateNotificationGroup->chat_id_);
-            if (chat == nullptr) continue;
-
             Notification* newNotification = new Notification;
             newNotification->setCategory("x-verdanditeam.yottagram.im");
             newNotification->setAppName("Yottagram");
@@ -0,0 +1,86 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "textlayoutservice.h"
+#include <QTextLayout>
+#include <QTextOption>
+#include <cmath>
+
+const int TextLayoutWorker::WIDE_TEXT_LENGTH = 30;
+
+void TextLayoutWorker::measure(qint64 chatId, quint32 revision, QFont font, qreal width, QVector<qint64> messageIds, QStringList texts)
+{
+    QVector<int> heights;
+    heights.reserve(texts.size());
+    for (auto &text: texts) {
+        heights.append(measureText(font, width, text));
+    }
+
+    emit measured(chatId, revision, messageIds, heights);
+}
+
+int TextLayoutWorker::measureText(const QFont &font, qreal width, QString text)
+{
+    text = text.trimmed();
+    if (text.isEmpty()) return 0;
+
+    QTextOption option;
+    option.setWrapMode(text.length() > WIDE_TEXT_LENGTH ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
+
+    QTextLayout layout(text.replace('\n', QChar::LineSeparator), font);
+    layout.setTextOption(option);
+    layout.setCacheEnabled(false);
+
+    qreal height = 0;
+    layout.beginLayout();
+    forever {
+        auto line = layout.createLine();
+        if (!line.isValid()) break;
+
+        line.setLineWidth(width);
+        height += line.height();
+    }
+    layout.endLayout();
+
+    return std::ceil(height);
+}
+
+TextLayoutService::TextLayoutService(QObject *parent) : QObject(parent), _worker(new TextLayoutWorker())
+{
+    _worker->moveToThread(&_workerThread);
+    connect(&_workerThread, SIGNAL(finished()), _worker, SLOT(deleteLater()));
+    connect(this, SIGNAL(measureRequested(qint64,quint32,QFont,qreal,QVector<qint64>,QStringList)), _worker, SLOT(measure(qint64,quint32,QFont,qreal,QVector<qint64>,QStringList)));
+    connect(_worker, SIGNAL(measured(qint64,quint32,QVector<qint64>,QVector<int>)), this, SIGNAL(measured(qint64,quint32,QVector<qint64>,QVector<int>)));
+    _workerThread.start(QThread::LowPriority);
+}
+
+TextLayoutService::~TextLayoutService()
+{
+    _workerThread.quit();
+    _workerThread.wait();
+}
+
+void TextLayoutService::measure(qint64 chatId, quint32 revision, const QFont &font, qreal width, const QVector<qint64> &messageIds, const QStringList &texts)
+{
+    if (messageIds.isEmpty()) return;
+
+    emit measureRequested(chatId, revision, font, width, messageIds, texts);
+}
@@ -0,0 +1,64 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef TEXTLAYOUTSERVICE_H
+#define TEXTLAYOUTSERVICE_H
+
+#include <QObject>
+#include <QThread>
+#include <QFont>
+#include <QVector>
+#include <QStringList>
+
+class TextLayoutWorker : public QObject
+{
+    Q_OBJECT
+signals:
+    void measured(qint64 chatId, quint32 revision, QVector<qint64> messageIds, QVector<int> heights);
+
+public slots:
+    void measure(qint64 chatId, quint32 revision, QFont font, qreal width, QVector<qint64> messageIds, QStringList texts);
+
+private:
+    static const int WIDE_TEXT_LENGTH;
+
+    static int measureText(const QFont &font, qreal width, QString text);
+};
+
+class TextLayoutService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TextLayoutService(QObject *parent = nullptr);
+    ~TextLayoutService();
+
+    void measure(qint64 chatId, quint32 revision, const QFont &font, qreal width, const QVector<qint64> &messageIds, const QStringList &texts);
+
+signals:
+    void measureRequested(qint64 chatId, quint32 revision, QFont font, qreal width, QVector<qint64> messageIds, QStringList texts);
+    void measured(qint64 chatId, quint32 revision, QVector<qint64> messageIds, QVector<int> heights);
+
+private:
+    QThread _workerThread;
+    TextLayoutWorker* _worker;
+};
+
+#endif // TEXTLAYOUTSERVICE_H
@@ -52,6 +52,7 @@ void User::setUser(td_api::user *user)
 {
     if (_user != nullptr) delete _user;
     _user = user;
+    _name = QString::fromStdString(_user->first_name_) + " " + QString::fromStdString(_user->last_name_);
 
     emit userChanged();
 
@@ -70,7 +71,7 @@ void User::setUser(td_api::user *user)
 
 QString User::getName() const
 {
-    return QString::fromStdString(_user->first_name_) + " " + QString::fromStdString(_user->last_name_);
+    return _name;
 }
 
 QString User::getUserame() const
@@ -107,6 +107,7 @@ public slots:
 
 private:
     td_api::user* _user;
+    QString _name;
     shared_ptr<TelegramManager> _manager;
     shared_ptr<Files> _files;
     qint32 _smallPhotoId;
@@ -0,0 +1,3 @@
+TDLIB_LIBS = /usr/lib/libtdclient.so.1.6.0 /usr/lib/libtdcore.a /usr/lib/libtdutils.a
+
+LIBS += -lssl -pthread $$TDLIB_LIBS
@@ -0,0 +1,96 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "core/telegrammanager.h"
+
+// Offline stand-in for the TDLib client: queries are dropped and never answered.
+
+TelegramReceiver::TelegramReceiver()
+{
+}
+
+void TelegramReceiver::run()
+{
+}
+
+TelegramManager::TelegramManager() : _myId(0), _networkManager(nullptr)
+{
+}
+
+void TelegramManager::init()
+{
+}
+
+quint64 TelegramManager::sendQuery(td_api::Function* message)
+{
+    delete message;
+    return ++_lastQueryId;
+}
+
+qint32 TelegramManager::getMyId() const
+{
+    return _myId;
+}
+
+bool TelegramManager::isConnected() const
+{
+    return _isConnected;
+}
+
+bool TelegramManager::getDaemonEnabled() const
+{
+    return false;
+}
+
+void TelegramManager::setDaemonEnabled(bool daemonEnabled)
+{
+    Q_UNUSED(daemonEnabled)
+}
+
+void TelegramManager::setNetworkType(QString networkType)
+{
+    _networkType = networkType;
+}
+
+QString TelegramManager::getNetworkType() const
+{
+    return _networkType;
+}
+
+void TelegramManager::messageReceived(quint64 id, td_api::Object* message)
+{
+    Q_UNUSED(id)
+    Q_UNUSED(message)
+}
+
+void TelegramManager::onUpdateOption(td_api::updateOption *updateOption)
+{
+    Q_UNUSED(updateOption)
+}
+
+void TelegramManager::onUpdateConnectionState(td_api::updateConnectionState *updateConnectionState)
+{
+    Q_UNUSED(updateConnectionState)
+}
+
+void TelegramManager::defaultRouteChanged(NetworkService *networkService)
+{
+    Q_UNUSED(networkService)
+}
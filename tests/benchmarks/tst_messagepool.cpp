@@ -0,0 +1,218 @@
+/*
+
+This file is part of Yottagram.
+Copyright 2020, Michał Szczepaniak <m.szczepaniak.000@gmail.com>
+
+Yottagram is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Yottagram is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Yottagram. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <QtTest>
+#include <cstdlib>
+#include <new>
+#include "chat.h"
+#include "chatsummary.h"
+
+static qint64 allocationCount = 0;
+static bool isCountingAllocations = false;
+
+void* operator new(std::size_t size)
+{
+    if (isCountingAllocations) ++allocationCount;
+
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+class tst_MessagePool : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void newMessages();
+    void historyPages();
+
+private:
+    static const int MESSAGE_COUNT;
+    static const int PAGE_SIZE;
+    static const int64_t CHAT_ID;
+    static const double MAX_POOLED_RATIO;
+
+    static td_api::object_ptr<td_api::chat> createChat();
+    static td_api::object_ptr<td_api::message> createMessage(int id, td_api::object_ptr<td_api::MessageContent> content);
+    static std::vector<td_api::object_ptr<td_api::message>> createTextMessages();
+    static std::vector<td_api::object_ptr<td_api::message>> createPhotoMessages();
+    qint64 countNewMessageAllocations(bool pooled);
+    qint64 countHistoryPageAllocations(bool pooled);
+    void compareAllocations(qint64 pooled, qint64 unpooled);
+
+    shared_ptr<TelegramManager> _manager;
+};
+
+const int tst_MessagePool::MESSAGE_COUNT = 10000;
+const int tst_MessagePool::PAGE_SIZE = 100;
+const int64_t tst_MessagePool::CHAT_ID = 1;
+const double tst_MessagePool::MAX_POOLED_RATIO = 0.9;
+
+void tst_MessagePool::initTestCase()
+{
+    _manager = std::make_shared<TelegramManager>();
+}
+
+td_api::object_ptr<td_api::chat> tst_MessagePool::createChat()
+{
+    auto chat = td_api::make_object<td_api::chat>();
+    chat->id_ = CHAT_ID;
+    chat->type_ = td_api::make_object<td_api::chatTypePrivate>(1);
+    return chat;
+}
+
+td_api::object_ptr<td_api::message> tst_MessagePool::createMessage(int id, td_api::object_ptr<td_api::MessageContent> content)
+{
+    auto message = td_api::make_object<td_api::message>();
+    message->id_ = id;
+    message->chat_id_ = CHAT_ID;
+    message->sender_user_id_ = 1;
+    message->date_ = 1600000000 + id;
+    message->content_ = std::move(content);
+    return message;
+}
+
+std::vector<td_api::object_ptr<td_api::message>> tst_MessagePool::createTextMessages()
+{
+    std::vector<td_api::object_ptr<td_api::message>> messages;
+    messages.reserve(MESSAGE_COUNT);
+    for (int i = 1; i <= MESSAGE_COUNT; ++i) {
+        auto content = td_api::make_object<td_api::messageText>();
+        content->text_ = td_api::make_object<td_api::formattedText>();
+        content->text_->text_ = "Message " + std::to_string(i);
+        messages.push_back(createMessage(i, std::move(content)));
+    }
+
+    return messages;
+}
+
+std::vector<td_api::object_ptr<td_api::message>> tst_MessagePool::createPhotoMessages()
+{
+    std::vector<td_api::object_ptr<td_api::message>> messages;
+    messages.reserve(MESSAGE_COUNT);
+    for (int i = 1; i <= MESSAGE_COUNT; ++i) {
+        auto file = td_api::make_object<td_api::file>();
+        file->id_ = i;
+        file->local_ = td_api::make_object<td_api::localFile>();
+        file->local_->is_downloading_completed_ = true;
+        file->remote_ = td_api::make_object<td_api::remoteFile>();
+
+        auto size = td_api::make_object<td_api::photoSize>();
+        size->type_ = "x";
+        size->photo_ = std::move(file);
+        size->width_ = 800;
+        size->height_ = 600;
+
+        auto content = td_api::make_object<td_api::messagePhoto>();
+        content->photo_ = td_api::make_object<td_api::photo>();
+        content->photo_->sizes_.push_back(std::move(size));
+        content->caption_ = td_api::make_object<td_api::formattedText>();
+        content->caption_->text_ = "Photo " + std::to_string(i);
+        messages.push_back(createMessage(i, std::move(content)));
+    }
+
+    return messages;
+}
+
+qint64 tst_MessagePool::countNewMessageAllocations(bool pooled)
+{
+    auto files = std::make_shared<Files>();
+    files->setTelegramManager(_manager);
+    auto chatObject = createChat();
+    ChatSummary summary(chatObject.get());
+    Chat chat(&summary, files);
+    chat.setTelegramManager(_manager);
+    chat.setPoolingEnabled(pooled);
+    auto messages = createTextMessages();
+
+    allocationCount = 0;
+    isCountingAllocations = true;
+    for (auto &message: messages) {
+        chat.newMessage(std::move(message));
+    }
+    isCountingAllocations = false;
+
+    return chat.rowCount() > 0 ? allocationCount : -1;
+}
+
+qint64 tst_MessagePool::countHistoryPageAllocations(bool pooled)
+{
+    auto files = std::make_shared<Files>();
+    files->setTelegramManager(_manager);
+    auto chatObject = createChat();
+    ChatSummary summary(chatObject.get());
+    Chat chat(&summary, files);
+    chat.setTelegramManager(_manager);
+    chat.setPoolingEnabled(pooled);
+    auto messages = createPhotoMessages();
+
+    allocationCount = 0;
+    isCountingAllocations = true;
+    for (int i = MESSAGE_COUNT; i > 0; i -= PAGE_SIZE) {
+        QVector<Message*> page;
+        for (int j = i; j > i - PAGE_SIZE && j > 0; --j) {
+            page.append(chat.createMessage(std::move(messages[j - 1])));
+        }
+        chat.insertMessages(page);
+
+        for (int row = std::max(chat.rowCount() - PAGE_SIZE, 0); row < chat.rowCount(); ++row) {
+            chat.data(chat.index(row), Chat::FileRole);
+        }
+    }
+    isCountingAllocations = false;
+
+    return chat.rowCount() > 0 ? allocationCount : -1;
+}
+
+void tst_MessagePool::compareAllocations(qint64 pooled, qint64 unpooled)
+{
+    QTest::setBenchmarkResult(pooled, QTest::Events);
+    QVERIFY(pooled > 0 && unpooled > 0);
+    QVERIFY2(pooled < unpooled * MAX_POOLED_RATIO, qPrintable(QString("%1 allocations with pooling, %2 without").arg(pooled).arg(unpooled)));
+}
+
+void tst_MessagePool::newMessages()
+{
+    auto unpooled = countNewMessageAllocations(false);
+    auto pooled = countNewMessageAllocations(true);
+    compareAllocations(pooled, unpooled);
+}
+
+void tst_MessagePool::historyPages()
+{
+    auto unpooled = countHistoryPageAllocations(false);
+    auto pooled = countHistoryPageAllocations(true);
+    compareAllocations(pooled, unpooled);
+}
+
+QTEST_MAIN(tst_MessagePool)
+
+#include "tst_messagepool.moc"
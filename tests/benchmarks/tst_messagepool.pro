@@ -0,0 +1,72 @@
+include(../../tdlib.pri)
+
+TARGET = tst_messagepool
+
+QT += testlib qml quick
+
+CONFIG += c++11 c++14 link_pkgconfig testcase
+
+QMAKE_CXXFLAGS += -std=c++14
+
+PKGCONFIG += zlib openssl connman-qt5
+
+SRC = ../../src
+
+INCLUDEPATH += $$SRC
+
+SOURCES += tst_messagepool.cpp \
+    stubtelegrammanager.cpp \
+    $$SRC/components/autodownloadsettings.cpp \
+    $$SRC/components/basicgroupfullinfo.cpp \
+    $$SRC/components/supergroupfullinfo.cpp \
+    $$SRC/components/userfullinfo.cpp \
+    $$SRC/files/animation.cpp \
+    $$SRC/files/audio.cpp \
+    $$SRC/files/contentfile.cpp \
+    $$SRC/files/document.cpp \
+    $$SRC/files/file.cpp \
+    $$SRC/files/files.cpp \
+    $$SRC/files/photo.cpp \
+    $$SRC/files/sticker.cpp \
+    $$SRC/files/video.cpp \
+    $$SRC/files/videonote.cpp \
+    $$SRC/files/voicenote.cpp \
+    $$SRC/message.cpp \
+    $$SRC/poll.cpp \
+    $$SRC/user.cpp \
+    $$SRC/users.cpp \
+    $$SRC/webpage.cpp \
+    $$SRC/chatsummary.cpp \
+    $$SRC/contentpool.cpp \
+    $$SRC/expirywheel.cpp \
+    $$SRC/textlayoutservice.cpp \
+    $$SRC/chat.cpp
+
+HEADERS += \
+    $$SRC/components/autodownloadsettings.h \
+    $$SRC/components/basicgroupfullinfo.h \
+    $$SRC/components/supergroupfullinfo.h \
+    $$SRC/components/userfullinfo.h \
+    $$SRC/files/animation.h \
+    $$SRC/files/audio.h \
+    $$SRC/files/contentfile.h \
+    $$SRC/files/document.h \
+    $$SRC/files/file.h \
+    $$SRC/files/files.h \
+    $$SRC/files/photo.h \
+    $$SRC/files/sticker.h \
+    $$SRC/files/video.h \
+    $$SRC/files/videonote.h \
+    $$SRC/files/voicenote.h \
+    $$SRC/message.h \
+    $$SRC/core/telegramreceiver.h \
+    $$SRC/core/telegrammanager.h \
+    $$SRC/chatsummary.h \
+    $$SRC/contentpool.h \
+    $$SRC/expirywheel.h \
+    $$SRC/textlayoutservice.h \
+    $$SRC/chat.h \
+    $$SRC/poll.h \
+    $$SRC/user.h \
+    $$SRC/users.h \
+    $$SRC/webpage.h
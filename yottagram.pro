@@ -1,8 +1,9 @@
 include(vendor/vendor.pri)
+include(tdlib.pri)
 
 TARGET = yottagram
 
-QT += dbus multimedia
+QT += dbus multimedia quick-private
 
 CONFIG +=  c++11 c++14 link_pkgconfig sailfishapp iostream
 
@@ -16,6 +17,7 @@ SOURCES += src/core.cpp \
     src/components/basicgroupfullinfo.cpp \
     src/components/scopenotificationsettings.cpp \
     src/components/supergroupfullinfo.cpp \
+    src/components/textbubble.cpp \
     src/components/thumbnail.cpp \
     src/components/userfullinfo.cpp \
     src/files/animation.cpp \
@@ -42,6 +44,12 @@ SOURCES += src/core.cpp \
     src/core/telegramreceiver.cpp \
     src/core/telegrammanager.cpp \
     src/chatlist.cpp \
+    src/chatlistmodel.cpp \
+    src/chatsearchmodel.cpp \
+    src/chatsummary.cpp \
+    src/contentpool.cpp \
+    src/expirywheel.cpp \
+    src/textlayoutservice.cpp \
     src/chat.cpp
 
 DISTFILES += qml/yottagram.qml \
@@ -105,6 +113,7 @@ HEADERS += \
     src/components/basicgroupfullinfo.h \
     src/components/scopenotificationsettings.h \
     src/components/supergroupfullinfo.h \
+    src/components/textbubble.h \
     src/components/thumbnail.h \
     src/components/userfullinfo.h \
     src/core.h \
@@ -126,6 +135,12 @@ HEADERS += \
     src/core/telegramreceiver.h \
     src/core/telegrammanager.h \
     src/chatlist.h \
+    src/chatlistmodel.h \
+    src/chatsearchmodel.h \
+    src/chatsummary.h \
+    src/contentpool.h \
+    src/expirywheel.h \
+    src/textlayoutservice.h \
     src/chat.h \
     src/poll.h \
     src/stickerset.h \
@@ -134,8 +149,6 @@ HEADERS += \
     src/users.h \
     src/webpage.h
 
-LIBS = -lssl -pthread /usr/lib/libtdclient.so.1.6.0 /usr/lib/libtdcore.a /usr/lib/libtdutils.a
-
 RESOURCES += \
     lottie.qrc \
     qml/resources/icons.qrc